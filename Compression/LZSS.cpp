@@ -0,0 +1,268 @@
+/*
+ * @file    LZSS.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Small-window LZSS compression with fixed RAM use.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "LZSS.h"
+
+#include <string.h>
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** compress
+ * @brief	Compresses a buffer.
+ * @param	Input
+ * @param	Input length
+ * @param	Output buffer
+ * @param	Output buffer length
+ * @return  Compressed length, negative if it does not fit
+ */
+int LZSS::compress(const uint8_t *in, size_t inlen, uint8_t *out, size_t outlen){
+    size_t pos = 0;
+    size_t o = 0;
+    size_t flag_pos = 0;
+    int item = 8;
+
+    while(pos < inlen){
+        if(item == 8){
+            // start a new group of eight items
+            if(o >= outlen){
+                return LZSS_ERROR_BUFFER_TOO_SHORT;
+            }
+            flag_pos = o++;
+            out[flag_pos] = 0;
+            item = 0;
+        }
+
+        // longest match in the window, nearest first
+        size_t best_len = 0;
+        size_t best_dist = 0;
+        size_t max_len = inlen - pos < LZSS_MAX_MATCH ? inlen - pos : LZSS_MAX_MATCH;
+        size_t first = pos > LZSS_WINDOW_SIZE ? pos - LZSS_WINDOW_SIZE : 0;
+        for(size_t cand = pos; cand-- > first && best_len < max_len;){
+            if(in[cand] != in[pos] || in[cand + best_len] != in[pos + best_len]){
+                continue;
+            }
+            size_t len = 0;
+            while(len < max_len && in[cand + len] == in[pos + len]){
+                len++;
+            }
+            if(len > best_len){
+                best_len = len;
+                best_dist = pos - cand;
+            }
+        }
+
+        if(best_len >= LZSS_MIN_MATCH){
+            if(outlen - o < 2){
+                return LZSS_ERROR_BUFFER_TOO_SHORT;
+            }
+            size_t dist = best_dist - 1;
+            out[o++] = (uint8_t)dist;
+            out[o++] = (uint8_t)(((dist >> 8) << LZSS_LENGTH_BITS) | (best_len - LZSS_MIN_MATCH));
+            pos += best_len;
+        }
+        else{
+            if(o >= outlen){
+                return LZSS_ERROR_BUFFER_TOO_SHORT;
+            }
+            out[flag_pos] |= 1 << item;
+            out[o++] = in[pos++];
+        }
+        item++;
+    }
+    return (int)o;
+}
+
+/** decompress
+ * @brief	Decompresses a buffer, using the output itself as the window.
+ * @param	Input
+ * @param	Input length
+ * @param	Output buffer
+ * @param	Output buffer length
+ * @return  Decompressed length, negative on error
+ */
+int LZSS::decompress(const uint8_t *in, size_t inlen, uint8_t *out, size_t outlen){
+    size_t i = 0;
+    size_t o = 0;
+
+    while(i < inlen){
+        uint8_t flags = in[i++];
+        for(int item = 0; item < 8 && i < inlen; item++){
+            if(flags & (1 << item)){
+                if(o >= outlen){
+                    return LZSS_ERROR_BUFFER_TOO_SHORT;
+                }
+                out[o++] = in[i++];
+                continue;
+            }
+            if(inlen - i < 2){
+                return LZSS_ERROR_CORRUPT;
+            }
+            size_t dist = (in[i] | ((in[i + 1] >> LZSS_LENGTH_BITS) << 8)) + 1;
+            size_t len = (in[i + 1] & ((1 << LZSS_LENGTH_BITS) - 1)) + LZSS_MIN_MATCH;
+            i += 2;
+            if(dist > o){
+                return LZSS_ERROR_CORRUPT;
+            }
+            if(outlen - o < len){
+                return LZSS_ERROR_BUFFER_TOO_SHORT;
+            }
+            // byte by byte, matches may overlap their own output
+            for(size_t k = 0; k < len; k++, o++){
+                out[o] = out[o - dist];
+            }
+        }
+    }
+    return (int)o;
+}
+
+/** Constructor
+ * @brief	Constructor.
+ * @param	Function receiving the decompressed data
+ * @param	Context passed to the sink
+ */
+LZSSDecoder::LZSSDecoder(lzss_sink_t _sink, void *_context){
+    sink = _sink;
+    context = _context;
+    reset();
+}
+
+/** reset
+ * @brief	Prepares the decoder for a new stream.
+ */
+void LZSSDecoder::reset(){
+    head = 0;
+    outlen = 0;
+    total = 0;
+    items = 0;
+    hasPending = false;
+}
+
+/** emit
+ * @brief	Appends one byte to the window and to the output chunk.
+ * @param	Byte
+ * @return  Return code
+ */
+int LZSSDecoder::emit(uint8_t c){
+    window[head] = c;
+    head = (head + 1) & (LZSS_WINDOW_SIZE - 1);
+    total++;
+
+    out[outlen++] = c;
+    if(outlen == LZSS_OUT_CHUNK){
+        outlen = 0;
+        if(sink(context, out, LZSS_OUT_CHUNK) != 0){
+            return LZSS_ERROR_SINK;
+        }
+    }
+    return 0;
+}
+
+/** feed
+ * @brief	Decompresses the next chunk of the stream.
+ * @param	Input
+ * @param	Input length
+ * @return  Return code
+ */
+int LZSSDecoder::feed(const uint8_t *in, size_t inlen){
+    size_t i = 0;
+    int rc;
+
+    while(i < inlen){
+        if(items == 0){
+            flags = in[i++];
+            items = 8;
+            continue;
+        }
+
+        if(flags & 1){
+            if((rc = emit(in[i++])) != 0){
+                return rc;
+            }
+        }
+        else{
+            if(!hasPending){
+                // keep the first half of the reference until its second byte arrives
+                pending = in[i++];
+                hasPending = true;
+                continue;
+            }
+            uint8_t second = in[i++];
+            size_t dist = (pending | ((second >> LZSS_LENGTH_BITS) << 8)) + 1;
+            size_t len = (second & ((1 << LZSS_LENGTH_BITS) - 1)) + LZSS_MIN_MATCH;
+            hasPending = false;
+            if(dist > total){
+                return LZSS_ERROR_CORRUPT;
+            }
+            for(size_t k = 0; k < len; k++){
+                if((rc = emit(window[(head - dist) & (LZSS_WINDOW_SIZE - 1)])) != 0){
+                    return rc;
+                }
+            }
+        }
+        flags >>= 1;
+        items--;
+    }
+    return 0;
+}
+
+/** finish
+ * @brief	Hands the last buffered bytes to the sink.
+ * @return  Return code
+ */
+int LZSSDecoder::finish(){
+    if(hasPending){
+        return LZSS_ERROR_CORRUPT;
+    }
+    if(outlen > 0){
+        size_t len = outlen;
+        outlen = 0;
+        if(sink(context, out, len) != 0){
+            return LZSS_ERROR_SINK;
+        }
+    }
+    return 0;
+}
+
+/** produced
+ * @brief	Returns the number of bytes decompressed so far.
+ * @return  Number of bytes
+ */
+size_t LZSSDecoder::produced(){
+    return total;
+}
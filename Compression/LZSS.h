@@ -0,0 +1,121 @@
+/*
+ * @file    LZSS.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Small-window LZSS compression with fixed RAM use.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+
+#ifndef _LZSS_H_
+#define _LZSS_H_
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Constants -----------------------------------------------------------------*/
+
+#define LZSS_WINDOW_BITS   10
+#define LZSS_LENGTH_BITS   6
+#define LZSS_WINDOW_SIZE   (1 << LZSS_WINDOW_BITS)                // 1024 bytes of history
+#define LZSS_MIN_MATCH     3
+#define LZSS_MAX_MATCH     (LZSS_MIN_MATCH + (1 << LZSS_LENGTH_BITS) - 1)
+#define LZSS_OUT_CHUNK     64
+
+#define LZSS_ERROR_BUFFER_TOO_SHORT  -1
+#define LZSS_ERROR_CORRUPT           -2
+#define LZSS_ERROR_SINK              -3
+
+/**
+ * Receives decompressed data, returns 0 to continue.
+ */
+typedef int (*lzss_sink_t)(void *context, const uint8_t *data, size_t len);
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * LZSS codec in the spirit of heatshrink.
+ *
+ * A flag byte announces the next eight items, a set bit for a literal byte
+ * and a clear bit for a two byte back reference: a 10 bit distance into the
+ * last 1 KB of output and a 6 bit match length (3 to 66 bytes).
+ *
+ * Compression works on a buffer in memory. Decompression is available both
+ * in one shot and streaming; the streaming decoder keeps only the window.
+ */
+class LZSS{
+public:
+    static int compress(const uint8_t *in, size_t inlen, uint8_t *out, size_t outlen);
+
+    static int decompress(const uint8_t *in, size_t inlen, uint8_t *out, size_t outlen);
+};
+
+/**
+ * Streaming LZSS decoder, fed with chunks of any size.
+ */
+class LZSSDecoder{
+private:
+    uint8_t window[LZSS_WINDOW_SIZE];
+    uint8_t out[LZSS_OUT_CHUNK];
+    size_t head;
+    size_t outlen;
+    size_t total;
+
+    uint8_t flags;
+    uint8_t items;      // items left under the current flag byte
+    uint8_t pending;    // first byte of a back reference split across chunks
+    bool hasPending;
+
+    lzss_sink_t sink;
+    void *context;
+
+    int emit(uint8_t c);
+
+public:
+
+    /* Constructors */
+    LZSSDecoder(lzss_sink_t _sink, void *_context);
+
+    /* Functions */
+
+    void reset();
+
+    int feed(const uint8_t *in, size_t inlen);
+
+    int finish();
+
+    size_t produced();
+};
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * @file    DeferredLog.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Deferred binary logging drained by a low priority thread.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "DeferredLog.h"
+
+#include <ctype.h>
+#include <string.h>
+
+/* Class Implementation ------------------------------------------------------*/
+
+DeferredLogRecord DeferredLog::records[DLOG_DEPTH];
+volatile uint32_t DeferredLog::head = 0;
+volatile uint32_t DeferredLog::tail = 0;
+uint32_t DeferredLog::droppedCount = 0;
+Semaphore DeferredLog::pending(0);
+Thread *DeferredLog::thread = NULL;
+
+/** put_word
+ * @brief	Appends a raw argument word to a record.
+ * @param	Record
+ * @param	Word
+ * @return  False if the record is full
+ */
+static bool put_word(DeferredLogRecord &r, uint32_t word){
+    if(r.words >= DLOG_MAX_WORDS){
+        r.flags |= DLOG_FLAG_TRUNCATED;
+        return false;
+    }
+    r.args[r.words++] = word;
+    return true;
+}
+
+/** put_words
+ * @brief	Appends a 64 bit argument to a record, low word first.
+ * @param	Record
+ * @param	Argument bytes
+ * @return  False if the record is full
+ */
+static bool put_words(DeferredLogRecord &r, const void *data){
+    uint32_t words[2];
+    memcpy(words, data, sizeof(words));
+    if(r.words + 2 > DLOG_MAX_WORDS){
+        r.flags |= DLOG_FLAG_TRUNCATED;
+        return false;
+    }
+    r.args[r.words++] = words[0];
+    r.args[r.words++] = words[1];
+    return true;
+}
+
+/** put_string
+ * @brief	Copies a string argument into a record.
+ * @param	Record
+ * @param	String
+ * @param	Precision, negative for none
+ * @return  False if the record is full
+ */
+static bool put_string(DeferredLogRecord &r, const char *s, int precision){
+    if(r.stringsLen >= DLOG_STRING_LEN){
+        r.flags |= DLOG_FLAG_TRUNCATED;
+        return false;
+    }
+    if(s == NULL){
+        s = "(null)";
+    }
+    int room = DLOG_STRING_LEN - r.stringsLen - 1;   // keep one byte for the terminator
+    int len = 0;
+    while(len < room && (precision < 0 || len < precision) && s[len] != '\0'){
+        r.strings[r.stringsLen + len] = s[len];
+        len++;
+    }
+    if(len == room && s[len] != '\0' && (precision < 0 || len < precision)){
+        r.flags |= DLOG_FLAG_TRUNCATED;
+    }
+    r.strings[r.stringsLen + len] = '\0';
+    r.stringsLen += len + 1;
+    return true;
+}
+
+/** write
+ * @brief	Queues a printf-style message.
+ * @param	Format, a string literal
+ * @param	Arguments
+ */
+void DeferredLog::write(const char *format, ...){
+    va_list args;
+    va_start(args, format);
+    vwrite(format, args);
+    va_end(args);
+}
+
+/** vwrite
+ * @brief	Queues a printf-style message. Walks the format only to take each
+ *          argument with its proper type; nothing is formatted.
+ * @param	Format, a string literal
+ * @param	Arguments
+ */
+void DeferredLog::vwrite(const char *format, va_list args){
+    DeferredLogRecord r;
+    r.time_us = us_ticker_read();
+    r.format = (uint32_t)(uintptr_t)format;
+    r.words = 0;
+    r.stringsLen = 0;
+    r.flags = 0;
+    r.reserved = 0;
+
+    bool room = true;
+    for(const char *p = format; *p != '\0' && room; p++){
+        if(*p != '%' || *++p == '%'){
+            continue;
+        }
+
+        while(*p != '\0' && strchr("-+ #0", *p) != NULL){
+            p++;
+        }
+        if(*p == '*'){
+            room = put_word(r, va_arg(args, int));
+            p++;
+        }
+        while(isdigit((unsigned char)*p)){
+            p++;
+        }
+
+        int precision = -1;
+        if(*p == '.'){
+            p++;
+            if(*p == '*'){
+                precision = va_arg(args, int);
+                room = room && put_word(r, precision);
+                p++;
+            }
+            else{
+                precision = 0;
+                while(isdigit((unsigned char)*p)){
+                    precision = precision * 10 + (*p++ - '0');
+                }
+            }
+        }
+
+        int longs = 0;
+        while(*p != '\0' && strchr("hlLjzt", *p) != NULL){
+            longs += (*p == 'l') ? 1 : (*p == 'j') ? 2 : 0;
+            p++;
+        }
+
+        switch(*p){
+            case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                if(longs >= 2){
+                    long long value = va_arg(args, long long);
+                    room = room && put_words(r, &value);
+                }
+                else if(longs == 1){
+                    room = room && put_word(r, (uint32_t)va_arg(args, long));
+                }
+                else{
+                    room = room && put_word(r, (uint32_t)va_arg(args, int));
+                }
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            {
+                double value = va_arg(args, double);
+                room = room && put_words(r, &value);
+                break;
+            }
+            case 's':
+                room = room && put_string(r, va_arg(args, const char *), precision);
+                break;
+            case 'p':
+                room = room && put_word(r, (uint32_t)(uintptr_t)va_arg(args, void *));
+                break;
+            case 'n':
+                (void)va_arg(args, void *);
+                break;
+            case '\0':
+                p--;    // stop at the terminator
+                break;
+        }
+    }
+
+    core_util_critical_section_enter();
+    if(head - tail >= DLOG_DEPTH){
+        droppedCount++;
+        core_util_critical_section_exit();
+        return;
+    }
+    records[head & (DLOG_DEPTH - 1)] = r;
+    head = head + 1;
+    core_util_critical_section_exit();
+
+    pending.release();
+}
+
+/** start
+ * @brief	Starts the thread printing the queued messages.
+ * @param	Thread priority, below the application threads
+ * @return  Return code
+ */
+int DeferredLog::start(osPriority priority){
+    if(thread){
+        return 1;
+    }
+    thread = new Thread(priority, 1024);
+    if(thread->start(drain_thread) != osOK){
+        delete thread;
+        thread = NULL;
+        return 2;
+    }
+    return 0;
+}
+
+/** drain
+ * @brief	Prints the queued messages as hex lines for tools/dlog_decode.py.
+ *          Only one thread may drain.
+ * @return  Number of messages printed
+ */
+int DeferredLog::drain(){
+    static uint32_t reportedDrops = 0;
+    int count = 0;
+
+    while(tail != head){
+        // a writer never reuses the slot at tail before tail moves on
+        DeferredLogRecord r = records[tail & (DLOG_DEPTH - 1)];
+        tail = tail + 1;
+
+        const unsigned char *p = (const unsigned char *)&r;
+        size_t header = (size_t)((const unsigned char *)r.args - p);
+        printf("DLOG ");
+        for(size_t i = 0; i < header + r.words * sizeof(uint32_t); i++){
+            printf("%02x", p[i]);
+        }
+        for(size_t i = 0; i < r.stringsLen; i++){
+            printf("%02x", (unsigned char)r.strings[i]);
+        }
+        printf("\r\n");
+        count++;
+    }
+
+    if(droppedCount != reportedDrops){
+        reportedDrops = droppedCount;
+        printf("DLOGDROP %lu\r\n", (unsigned long)reportedDrops);
+    }
+    return count;
+}
+
+/** dropped
+ * @brief	Returns the number of messages lost because the ring was full.
+ * @return  Number of messages
+ */
+uint32_t DeferredLog::dropped(){
+    return droppedCount;
+}
+
+/** drain_thread
+ * @brief	Prints messages as they are queued.
+ */
+void DeferredLog::drain_thread(){
+    while(true){
+        pending.wait();
+        drain();
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * @file    DeferredLog.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Deferred binary logging drained by a low priority thread.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _DEFERRED_LOG_H
+#define _DEFERRED_LOG_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+
+#include <stdarg.h>
+
+/* Constants -----------------------------------------------------------------*/
+
+#define DLOG_DEPTH        32    // records, a power of two
+#ifndef DLOG_MAX_WORDS
+#define DLOG_MAX_WORDS    10    // raw argument words per record, the Spirit1 address traces take 9
+#endif
+#define DLOG_STRING_LEN   24    // bytes of %s arguments copied per record
+
+#define DLOG_FLAG_TRUNCATED  0x01   // arguments did not fit the record
+
+/**
+ * Queues a printf-style message. The format must be a string literal: only
+ * its address is stored and tools/dlog_decode.py reads it back from the
+ * firmware image.
+ */
+#define DLOG(...) DeferredLog::write(__VA_ARGS__)
+
+/**
+ * One queued message: the format address plus its arguments as raw words,
+ * %s arguments copied into strings since they may not outlive the call.
+ */
+struct DeferredLogRecord {
+    uint32_t time_us;
+    uint32_t format;
+    uint8_t words;
+    uint8_t stringsLen;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t args[DLOG_MAX_WORDS];
+    char strings[DLOG_STRING_LEN];
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Logging that costs a few microseconds at the call site: no formatting,
+ * no UART. Records are printed as hex lines by a low priority thread.
+ * Safe from threads and interrupts.
+ *
+ * Defining DEFERRED_LOG routes the MQTTLogging.h macros, the ATParser
+ * debug_if and the Spirit1 tr_debug through it.
+ */
+class DeferredLog{
+private:
+    static DeferredLogRecord records[DLOG_DEPTH];
+    static volatile uint32_t head;
+    static volatile uint32_t tail;
+    static uint32_t droppedCount;
+    static Semaphore pending;
+    static Thread *thread;
+
+    static void drain_thread();
+
+public:
+
+    static void write(const char *format, ...);
+    static void vwrite(const char *format, va_list args);
+    static int start(osPriority priority = osPriorityLow);
+    static int drain();
+    static uint32_t dropped();
+
+};
+
+#endif
@@ -0,0 +1,279 @@
+/**
+ ******************************************************************************
+ * @file    DeltaPatch.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Streaming binary delta patches for firmware updates.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "DeltaPatch.h"
+
+#include <string.h>
+
+/* Constants -----------------------------------------------------------------*/
+
+#define STATE_HEADER    0
+#define STATE_CONTROL   1
+#define STATE_DIFF      2
+#define STATE_DIFF_RUN  3
+#define STATE_EXTRA     4
+#define STATE_DONE      5
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** read_le32
+ * @brief	Reads a little endian word.
+ * @param	Bytes
+ * @return  Word
+ */
+static uint32_t read_le32(const uint8_t *p){
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** Constructor
+ * @brief	Constructor.
+ * @param	Current image, memory mapped
+ * @param	Size of the current image
+ * @param	CRC32 of the current image, the patch must name the same
+ * @param	Sink for the new image
+ * @param	Context handed to the sink
+ */
+DeltaPatch::DeltaPatch(const uint8_t *_old, uint32_t _oldSize, uint32_t _oldCrc,
+                       delta_sink_t _sink, void *_context){
+    old = _old;
+    oldSize = _oldSize;
+    oldCrc = _oldCrc;
+    sink = _sink;
+    context = _context;
+    reset();
+}
+
+/** reset
+ * @brief	Prepares the patcher for a new patch.
+ */
+void DeltaPatch::reset(){
+    state = STATE_HEADER;
+    have = 0;
+    outlen = 0;
+    newSize = 0;
+    total = 0;
+    oldPos = 0;
+}
+
+/** emit
+ * @brief	Appends one byte to the output chunk.
+ * @param	Byte
+ * @return  Return code
+ */
+int DeltaPatch::emit(uint8_t c){
+    total++;
+    out[outlen++] = c;
+    if(outlen == DELTA_OUT_CHUNK){
+        outlen = 0;
+        if(sink(context, out, DELTA_OUT_CHUNK) != 0){
+            return DELTA_ERROR_SINK;
+        }
+    }
+    return 0;
+}
+
+/** feed
+ * @brief	Applies the next chunk of the patch.
+ * @param	Input
+ * @param	Input length
+ * @return  Return code
+ */
+int DeltaPatch::feed(const uint8_t *in, size_t inlen){
+    size_t i = 0;
+    int rc = 0;
+
+    while(i < inlen && rc == 0){
+        uint8_t c = in[i++];
+
+        switch(state){
+        case STATE_HEADER:
+            header[have++] = c;
+            if(have == DELTA_HEADER_SIZE){
+                rc = parse_header();
+            }
+            break;
+
+        case STATE_CONTROL:
+            field |= (uint32_t)(c & 0x7F) << shift;
+            shift += 7;
+            if(c & 0x80){
+                if(shift > 28){
+                    rc = DELTA_ERROR_CORRUPT;
+                }
+                break;
+            }
+            control[have++] = field;
+            field = 0;
+            shift = 0;
+            if(have == 3){
+                rc = start_record();
+            }
+            break;
+
+        case STATE_DIFF:
+            if(c == 0){
+                state = STATE_DIFF_RUN;
+                break;
+            }
+            rc = emit(old[oldPos++] + c);
+            if(rc == 0 && --remaining == 0){
+                rc = end_part();
+            }
+            break;
+
+        case STATE_DIFF_RUN:
+            // a run of unchanged bytes
+            if((uint32_t)c + 1 > remaining){
+                rc = DELTA_ERROR_CORRUPT;
+                break;
+            }
+            for(int k = 0; k <= c && rc == 0; k++){
+                rc = emit(old[oldPos++]);
+            }
+            remaining -= c + 1;
+            state = STATE_DIFF;
+            if(rc == 0 && remaining == 0){
+                rc = end_part();
+            }
+            break;
+
+        case STATE_EXTRA:
+            rc = emit(c);
+            if(rc == 0 && --remaining == 0){
+                rc = end_part();
+            }
+            break;
+
+        default:
+            rc = DELTA_ERROR_CORRUPT; // data after the end of the patch
+            break;
+        }
+    }
+    return rc;
+}
+
+/** finish
+ * @brief	Flushes the output once the whole patch has been fed.
+ * @return  Return code
+ */
+int DeltaPatch::finish(){
+    if(state != STATE_DONE){
+        return DELTA_ERROR_SHORT;
+    }
+    if(outlen > 0){
+        size_t len = outlen;
+        outlen = 0;
+        if(sink(context, out, len) != 0){
+            return DELTA_ERROR_SINK;
+        }
+    }
+    return 0;
+}
+
+/** produced
+ * @brief	Returns the number of bytes of the new image so far.
+ * @return  Number of bytes
+ */
+size_t DeltaPatch::produced(){
+    return total;
+}
+
+/** parse_header
+ * @brief	Checks the patch is meant for the current image.
+ * @return  Return code
+ */
+int DeltaPatch::parse_header(){
+    if(read_le32(header) != DELTA_MAGIC){
+        return DELTA_ERROR_CORRUPT;
+    }
+    if(read_le32(header + 4) != oldSize || read_le32(header + 12) != oldCrc){
+        return DELTA_ERROR_BASE;
+    }
+    newSize = read_le32(header + 8);
+
+    have = 0;
+    field = 0;
+    shift = 0;
+    state = newSize > 0 ? STATE_CONTROL : STATE_DONE;
+    return 0;
+}
+
+/** start_record
+ * @brief	Checks the lengths of a record against both images.
+ * @return  Return code
+ */
+int DeltaPatch::start_record(){
+    uint32_t diffLen = control[0];
+    uint32_t extraLen = control[1];
+
+    if(diffLen > newSize - total || extraLen > newSize - total - diffLen ||
+        diffLen > oldSize - oldPos){
+        return DELTA_ERROR_CORRUPT;
+    }
+
+    have = 0;
+    remaining = diffLen;
+    state = STATE_DIFF;
+    if(remaining == 0){
+        return end_part();
+    }
+    return 0;
+}
+
+/** end_part
+ * @brief	Moves from the diff to the extra part, or to the next record.
+ * @return  Return code
+ */
+int DeltaPatch::end_part(){
+    if(state == STATE_DIFF && control[1] > 0){
+        remaining = control[1];
+        state = STATE_EXTRA;
+        return 0;
+    }
+
+    // the seek is zigzag coded, the low bit is the sign
+    int32_t seek = (int32_t)(control[2] >> 1) ^ -(int32_t)(control[2] & 1);
+    if((seek < 0 && (uint32_t)-seek > oldPos) || (seek > 0 && (uint32_t)seek > oldSize - oldPos)){
+        return DELTA_ERROR_CORRUPT;
+    }
+    oldPos += seek;
+
+    state = total == newSize ? STATE_DONE : STATE_CONTROL;
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ * @file    DeltaPatch.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Streaming binary delta patches for firmware updates.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _DELTA_PATCH_H
+#define _DELTA_PATCH_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Constants -----------------------------------------------------------------*/
+
+#define DELTA_MAGIC          0x31504446 // "FDP1"
+#define DELTA_HEADER_SIZE    16
+#define DELTA_OUT_CHUNK      64
+
+#define DELTA_ERROR_CORRUPT  -1
+#define DELTA_ERROR_BASE     -2     // the patch is for another image
+#define DELTA_ERROR_SINK     -3
+#define DELTA_ERROR_SHORT    -4     // the patch ended early
+
+/**
+ * Receives the rebuilt image, returns 0 to continue.
+ */
+typedef int (*delta_sink_t)(void *context, const uint8_t *data, size_t len);
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Rebuilds a new image from the current one and a patch, fed in chunks of
+ * any size, with a fixed amount of RAM.
+ *
+ * The patch made by tools/delta_patch.cpp is a header (magic, old size,
+ * new size, CRC32 of the old image, little endian) and records of three
+ * LEB128 numbers: diff length, extra length and a zigzag coded seek. The
+ * diff bytes are added to the old image at the old position, a zero byte
+ * followed by n stands for n + 1 zeros. The extra bytes are copied as they
+ * are, then the old position moves by the seek.
+ */
+class DeltaPatch{
+private:
+    const uint8_t *old;
+    uint32_t oldSize;
+    uint32_t oldCrc;
+
+    uint8_t header[DELTA_HEADER_SIZE];
+    uint8_t out[DELTA_OUT_CHUNK];
+    size_t outlen;
+
+    int state;
+    size_t have;                // header bytes, or control fields, read so far
+    uint32_t field;             // LEB128 number being read
+    int shift;
+    uint32_t control[3];
+
+    uint32_t newSize;
+    uint32_t total;
+    uint32_t oldPos;
+    uint32_t remaining;         // bytes left in the diff or the extra part
+
+    delta_sink_t sink;
+    void *context;
+
+    int emit(uint8_t c);
+    int parse_header();
+    int start_record();
+    int end_part();
+
+public:
+
+    /* Constructors */
+    DeltaPatch(const uint8_t *_old, uint32_t _oldSize, uint32_t _oldCrc,
+               delta_sink_t _sink, void *_context);
+
+    /* Functions */
+
+    void reset();
+
+    int feed(const uint8_t *in, size_t inlen);
+
+    int finish();
+
+    size_t produced();
+};
+
+#endif
@@ -0,0 +1,553 @@
+/**
+ ******************************************************************************
+ * @file    FirmwareSlots.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   A/B firmware slots with a boot record in the key-value store.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FirmwareSlots.h"
+#include "OTAPipeline.h"
+#include "DeltaPatch.h"
+#include "LZSS.h"
+
+#include "mbedtls/sha256.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** get_slot_address
+ * @brief	Returns the start of a slot. Slot 0 starts the image area, slot 1
+ *          starts at the first sector boundary past its middle.
+ * @param	Slot
+ * @return  Slot address
+ */
+uint32_t FirmwareSlots::get_slot_address(int slot){
+    FlashIAP flash;
+    uint32_t start = Flasher::get_image_address();
+    uint32_t end = Flasher::get_flash_end();
+
+    if(slot == 0){
+        return start;
+    }
+
+    uint32_t addr = start + flash.get_sector_size(start);
+    while(addr < end && (addr - start) * 2 < end - start){
+        uint32_t next = addr + flash.get_sector_size(addr);
+        if((next - start) * 2 > end - start){
+            break;
+        }
+        addr = next;
+    }
+    return addr;
+}
+
+/** get_slot_size
+ * @brief	Returns the size of a slot.
+ * @param	Slot
+ * @return  Size in bytes
+ */
+uint32_t FirmwareSlots::get_slot_size(int slot){
+    if(slot == 0){
+        return get_slot_address(1) - get_slot_address(0);
+    }
+    return Flasher::get_flash_end() - get_slot_address(1);
+}
+
+/** get_active_slot
+ * @brief	Returns the slot the boot record points to.
+ * @return  Slot, or FIRMWARE_SLOT_NONE
+ */
+int FirmwareSlots::get_active_slot(){
+    FirmwareBootRecord record;
+    load(&record);
+    return record.active;
+}
+
+/** get_inactive_slot
+ * @brief	Returns the slot an update is written to.
+ * @return  Slot
+ */
+int FirmwareSlots::get_inactive_slot(){
+    return get_active_slot() == 0 ? 1 : 0;
+}
+
+/** get_state
+ * @brief	Returns whether the active slot is confirmed or on trial.
+ * @return  FIRMWARE_STATE_CONFIRMED or FIRMWARE_STATE_TRIAL
+ */
+int FirmwareSlots::get_state(){
+    FirmwareBootRecord record;
+    load(&record);
+    return record.state;
+}
+
+/** download
+ * @brief	Downloads an image into the inactive slot and installs it.
+ * @param	Network interface
+ * @param	URL
+ * @param	Expected SHA-256 of the image
+ * @param	Trusted CAs for an https URL
+ * @param	Whether the image was packed with tools/lzss_pack.cpp
+ * @return  Return code
+ */
+int FirmwareSlots::download(NetworkInterface *network, const char *url,
+                            const uint8_t sha256[32], const char *sslCaPem, bool compressed){
+    FirmwareUpdate *update = new FirmwareUpdate();
+    int rc = update->download(network, url, sslCaPem, sha256, false, compressed);
+    delete update;
+    return rc;
+}
+
+/** download_patch
+ * @brief	Downloads a patch made by tools/delta_patch.cpp against the
+ *          active image, and installs the image it rebuilds in the inactive
+ *          slot. Only the patch goes over the network.
+ * @param	Network interface
+ * @param	URL of the patch
+ * @param	Expected SHA-256 of the new image
+ * @param	Trusted CAs for an https URL
+ * @param	Whether the patch was packed with tools/lzss_pack.cpp
+ * @return  Return code, OTA_ERROR_STAGE if the patch does not apply, e.g.
+ *          because it was made for another image
+ */
+int FirmwareSlots::download_patch(NetworkInterface *network, const char *url,
+                                  const uint8_t sha256[32], const char *sslCaPem, bool compressed){
+    FirmwareUpdate *update = new FirmwareUpdate();
+    int rc = update->download(network, url, sslCaPem, sha256, true, compressed);
+    delete update;
+    return rc;
+}
+
+/** verify
+ * @brief	Checks the SHA-256 of the image in a slot.
+ * @param	Slot
+ * @param	Image size in bytes
+ * @param	Expected SHA-256
+ * @return  Return code
+ */
+int FirmwareSlots::verify(int slot, uint32_t size, const uint8_t sha256[32]){
+    uint8_t digest[32];
+
+    if(slot < 0 || slot >= FIRMWARE_SLOTS || size == 0){
+        return FIRMWARE_ERROR_NO_IMAGE;
+    }
+    if(size > get_slot_size(slot)){
+        return FIRMWARE_ERROR_TOO_LARGE;
+    }
+
+    // The slot is memory mapped, hash it in place
+    mbedtls_sha256((const unsigned char *)get_slot_address(slot), size, digest, 0);
+    if(memcmp(digest, sha256, sizeof(digest)) != 0){
+        return FIRMWARE_ERROR_VERIFY;
+    }
+    return 0;
+}
+
+/** install
+ * @brief	Verifies a written slot and makes it the active one, on trial
+ *          until the new image calls confirm().
+ * @param	Slot
+ * @param	Image size in bytes
+ * @param	Expected SHA-256
+ * @return  Return code
+ */
+int FirmwareSlots::install(int slot, uint32_t size, const uint8_t sha256[32]){
+    FirmwareBootRecord record;
+    if(load(&record) == FIRMWARE_ERROR_LAYOUT){
+        return FIRMWARE_ERROR_LAYOUT;
+    }
+
+    // Neither the running image nor the one to roll back to can be replaced
+    if(slot == record.active || record.state != FIRMWARE_STATE_CONFIRMED){
+        return FIRMWARE_ERROR_STATE;
+    }
+
+    int rc = verify(slot, size, sha256);
+    if(rc != 0){
+        return rc;
+    }
+
+    // The image runs in place, its reset handler has to be in the slot
+    uint32_t start = get_slot_address(slot);
+    uint32_t reset = ((const uint32_t *)start)[1] & ~1UL;
+    if(size < 8 || reset < start || reset >= start + size){
+        return FIRMWARE_ERROR_LINK;
+    }
+
+    record.previous = record.active;
+    record.active = slot;
+    record.state = FIRMWARE_STATE_TRIAL;
+    record.attempts = 0;
+    record.size[slot] = size;
+    memcpy(record.sha256[slot], sha256, 32);
+    return store(&record);
+}
+
+/** confirm
+ * @brief	Called by a new image once it is healthy, so it is kept.
+ * @return  Return code
+ */
+int FirmwareSlots::confirm(){
+    FirmwareBootRecord record;
+    load(&record);
+
+    if(record.state == FIRMWARE_STATE_CONFIRMED){
+        return 0;
+    }
+    record.state = FIRMWARE_STATE_CONFIRMED;
+    record.attempts = 0;
+    return store(&record);
+}
+
+/** rollback
+ * @brief	Drops the active image and makes the previous one active again.
+ * @return  Return code
+ */
+int FirmwareSlots::rollback(){
+    FirmwareBootRecord record;
+    load(&record);
+
+    if(record.active == FIRMWARE_SLOT_NONE){
+        return FIRMWARE_ERROR_NO_IMAGE;
+    }
+    roll_back(&record);
+    return store(&record);
+}
+
+/** select_boot_slot
+ * @brief	Picks the slot to boot, for the bootloader to call on every boot.
+ *          Counts the boots of an image on trial and rolls it back once they
+ *          run out, or if its hash does not match.
+ * @return  Slot to boot, or FIRMWARE_SLOT_NONE
+ */
+int FirmwareSlots::select_boot_slot(){
+    FirmwareBootRecord record;
+    bool changed = false;
+    load(&record);
+
+    if(record.active != FIRMWARE_SLOT_NONE && record.state == FIRMWARE_STATE_TRIAL){
+        if(record.attempts >= FIRMWARE_MAX_TRIAL_BOOTS){
+            roll_back(&record);
+        }
+        else{
+            // Counted before the image runs, so a crash counts as well
+            record.attempts++;
+        }
+        changed = true;
+    }
+
+    // Every pass drops a slot, so this ends with an intact image or none
+    while(record.active != FIRMWARE_SLOT_NONE &&
+        verify(record.active, record.size[record.active], record.sha256[record.active]) != 0){
+        roll_back(&record);
+        changed = true;
+    }
+
+    if(changed){
+        store(&record);
+    }
+    return record.active;
+}
+
+/** select_boot_address
+ * @brief	Picks the image to boot, see select_boot_slot(). Built into the
+ *          bootloader, where POST_APPLICATION_ADDR is the application.
+ * @return  Address of the image to start
+ */
+uint32_t FirmwareSlots::select_boot_address(){
+    int slot = select_boot_slot();
+    if(slot == FIRMWARE_SLOT_NONE){
+        return POST_APPLICATION_ADDR;
+    }
+    return get_slot_address(slot);
+}
+
+/** load
+ * @brief	Reads the boot record, or an empty one if there is none.
+ * @param	Record
+ * @return  Return code
+ */
+int FirmwareSlots::load(FirmwareBootRecord *record){
+    memset(record, 0, sizeof(FirmwareBootRecord));
+    record->magic = FIRMWARE_BOOT_MAGIC;
+    record->active = FIRMWARE_SLOT_NONE;
+    record->previous = FIRMWARE_SLOT_NONE;
+    record->state = FIRMWARE_STATE_CONFIRMED;
+
+    if(FLASHER_ADDRESS == 0){
+        // Without a fixed address the bootloader would look elsewhere, and
+        // opening the store here could format a sector of the application
+        return FIRMWARE_ERROR_LAYOUT;
+    }
+
+    FlashKV *kv = Flasher::get_kv();
+    uint32_t len = 0;
+    const void *stored = kv ? kv->get(FIRMWARE_BOOT_KEY, &len) : NULL;
+
+    if(stored && len == sizeof(FirmwareBootRecord) &&
+        ((const FirmwareBootRecord *)stored)->magic == FIRMWARE_BOOT_MAGIC){
+        memcpy(record, stored, sizeof(FirmwareBootRecord));
+        return 0;
+    }
+    return FIRMWARE_ERROR_NO_IMAGE;
+}
+
+/** store
+ * @brief	Replaces the boot record.
+ * @param	Record
+ * @return  Return code
+ */
+int FirmwareSlots::store(const FirmwareBootRecord *record){
+    if(FLASHER_ADDRESS == 0){
+        return FIRMWARE_ERROR_LAYOUT;
+    }
+    FlashKV *kv = Flasher::get_kv();
+    if(!kv){
+        return FIRMWARE_ERROR_STORE;
+    }
+    return kv->set(FIRMWARE_BOOT_KEY, record, sizeof(FirmwareBootRecord));
+}
+
+/** roll_back
+ * @brief	Forgets the image in the active slot and activates the previous
+ *          one, or none without a previous image, so the application
+ *          itself runs again.
+ * @param	Record
+ */
+void FirmwareSlots::roll_back(FirmwareBootRecord *record){
+    record->size[record->active] = 0;
+    record->active = record->previous;
+    record->previous = FIRMWARE_SLOT_NONE;
+    if(record->active != FIRMWARE_SLOT_NONE && record->size[record->active] == 0){
+        record->active = FIRMWARE_SLOT_NONE;
+    }
+    record->state = FIRMWARE_STATE_CONFIRMED;
+    record->attempts = 0;
+}
+
+/** Constructor
+ * @brief	Constructor.
+ */
+FirmwareUpdate::FirmwareUpdate(){
+    decoder = NULL;
+    patch = NULL;
+    stage.feed = stage_feed;
+    stage.finish = stage_finish;
+    stage.context = this;
+    slot = FIRMWARE_SLOT_NONE;
+}
+
+/** Destructor
+ * @brief	Destructor.
+ */
+FirmwareUpdate::~FirmwareUpdate(){
+    abort();
+}
+
+/** begin
+ * @brief	Starts writing an update to the inactive slot.
+ * @param	Whether the update is a patch against the active image
+ * @param	Whether the update is LZSS packed
+ * @return  Return code
+ */
+int FirmwareUpdate::begin(bool isPatch, bool compressed){
+    int rc = prepare(isPatch, compressed);
+    if(rc != 0){
+        return rc;
+    }
+    rc = pipeline.begin(FirmwareSlots::get_slot_address(slot), FirmwareSlots::get_slot_size(slot));
+    if(rc != 0){
+        release();
+    }
+    return rc;
+}
+
+/** feed
+ * @brief	Writes the next part of the update.
+ * @param	Data
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int FirmwareUpdate::feed(const void *data, uint32_t len){
+    if(slot == FIRMWARE_SLOT_NONE){
+        return FIRMWARE_ERROR_STATE;
+    }
+    return pipeline.receive(data, len);
+}
+
+/** finish
+ * @brief	Writes the rest of the update and installs the image.
+ * @param	Expected SHA-256 of the image
+ * @return  Return code
+ */
+int FirmwareUpdate::finish(const uint8_t sha256[32]){
+    if(slot == FIRMWARE_SLOT_NONE){
+        return FIRMWARE_ERROR_STATE;
+    }
+    int rc = pipeline.complete();
+    uint32_t size = pipeline.written();
+    int target = slot;
+    release();
+
+    if(rc != 0){
+        return rc;
+    }
+    return FirmwareSlots::install(target, size, sha256);
+}
+
+/** abort
+ * @brief	Drops the update, the active image stays as it is.
+ */
+void FirmwareUpdate::abort(){
+    pipeline.abort();
+    release();
+}
+
+/** download
+ * @brief	Downloads an update over HTTP or HTTPS and installs the image.
+ * @param	Network interface
+ * @param	URL
+ * @param	Trusted CAs for an https URL
+ * @param	Expected SHA-256 of the image
+ * @param	Whether the update is a patch against the active image
+ * @param	Whether the update is LZSS packed
+ * @return  Return code
+ */
+int FirmwareUpdate::download(NetworkInterface *network, const char *url, const char *sslCaPem,
+                             const uint8_t sha256[32], bool isPatch, bool compressed){
+    int rc = prepare(isPatch, compressed);
+    if(rc != 0){
+        return rc;
+    }
+    rc = pipeline.download(network, url, sslCaPem,
+                           FirmwareSlots::get_slot_address(slot), FirmwareSlots::get_slot_size(slot));
+    uint32_t size = pipeline.written();
+    int target = slot;
+    release();
+
+    if(rc != 0){
+        return rc;
+    }
+    return FirmwareSlots::install(target, size, sha256);
+}
+
+/** active
+ * @brief	Tells whether an update is being written.
+ * @return  True between begin() and finish() or abort()
+ */
+bool FirmwareUpdate::active(){
+    return slot != FIRMWARE_SLOT_NONE;
+}
+
+/** prepare
+ * @brief	Picks the slot and sets up the stages the update goes through.
+ * @param	Whether the update is a patch against the active image
+ * @param	Whether the update is LZSS packed
+ * @return  Return code
+ */
+int FirmwareUpdate::prepare(bool isPatch, bool compressed){
+    FirmwareBootRecord record;
+    if(FirmwareSlots::load(&record) == FIRMWARE_ERROR_LAYOUT){
+        return FIRMWARE_ERROR_LAYOUT;
+    }
+
+    if(slot != FIRMWARE_SLOT_NONE || record.state != FIRMWARE_STATE_CONFIRMED){
+        return FIRMWARE_ERROR_STATE; // the inactive slot holds the image to roll back to
+    }
+    if(isPatch && record.active == FIRMWARE_SLOT_NONE){
+        return FIRMWARE_ERROR_NO_IMAGE; // nothing to patch
+    }
+
+    slot = record.active == 0 ? 1 : 0;
+    if(isPatch){
+        // The base is read in place, the patch checks it is the image it was made for
+        const uint8_t *base = (const uint8_t *)FirmwareSlots::get_slot_address(record.active);
+        uint32_t baseSize = record.size[record.active];
+        patch = new DeltaPatch(base, baseSize, FlashRecord::crc32(0, base, baseSize),
+                               OTAPipeline::sink, &pipeline);
+    }
+    if(compressed){
+        decoder = new LZSSDecoder(unpacked, this);
+    }
+    pipeline.set_stage(isPatch || compressed ? &stage : NULL);
+    return 0;
+}
+
+/** release
+ * @brief	Frees the stages.
+ */
+void FirmwareUpdate::release(){
+    pipeline.set_stage(NULL);
+    delete decoder;
+    delete patch;
+    decoder = NULL;
+    patch = NULL;
+    slot = FIRMWARE_SLOT_NONE;
+}
+
+/** unpacked
+ * @brief	Passes unpacked data on to the patch, or the pipeline.
+ */
+int FirmwareUpdate::unpacked(void *context, const uint8_t *data, size_t len){
+    FirmwareUpdate *update = (FirmwareUpdate *)context;
+    if(update->patch){
+        return update->patch->feed(data, len);
+    }
+    return update->pipeline.feed(data, len);
+}
+
+/** stage_feed
+ * @brief	OTAStage feed() of the update.
+ */
+int FirmwareUpdate::stage_feed(void *context, const uint8_t *data, size_t len){
+    FirmwareUpdate *update = (FirmwareUpdate *)context;
+    if(update->decoder){
+        return update->decoder->feed(data, len);
+    }
+    return unpacked(context, data, len);
+}
+
+/** stage_finish
+ * @brief	OTAStage finish() of the update, flushes the stages in order.
+ */
+int FirmwareUpdate::stage_finish(void *context){
+    FirmwareUpdate *update = (FirmwareUpdate *)context;
+    int rc = 0;
+    if(update->decoder){
+        rc = update->decoder->finish();
+    }
+    if(rc == 0 && update->patch){
+        rc = update->patch->finish();
+    }
+    return rc;
+}
@@ -0,0 +1,185 @@
+/**
+ ******************************************************************************
+ * @file    FirmwareSlots.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   A/B firmware slots with a boot record in the key-value store.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _FIRMWARE_SLOTS_H
+#define _FIRMWARE_SLOTS_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "Flasher.h"
+#include "OTAPipeline.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+/* Boots an installed image gets to call confirm() before it is rolled back */
+#ifndef FIRMWARE_MAX_TRIAL_BOOTS
+#define FIRMWARE_MAX_TRIAL_BOOTS 3
+#endif
+
+#define FIRMWARE_SLOTS            2
+#define FIRMWARE_SLOT_NONE        -1
+
+#define FIRMWARE_BOOT_KEY         "fw.boot"
+#define FIRMWARE_BOOT_MAGIC       0x544F4F42 // "BOOT"
+
+#define FIRMWARE_STATE_CONFIRMED  0
+#define FIRMWARE_STATE_TRIAL      1
+
+#define FIRMWARE_ERROR_TOO_LARGE  FLASH_WRITER_ERROR_TOO_LARGE
+#define FIRMWARE_ERROR_STATE      FLASH_WRITER_ERROR_STATE
+#define FIRMWARE_ERROR_VERIFY     11
+#define FIRMWARE_ERROR_NO_IMAGE   12
+#define FIRMWARE_ERROR_STORE      13
+#define FIRMWARE_ERROR_LAYOUT     14    // FLASHER_ADDRESS is not set
+#define FIRMWARE_ERROR_LINK       15    // the image is linked for another address
+
+/**
+ * Which slot to boot, kept in the key-value store. Replacing it is a single
+ * record append, so it flips from one slot to the other atomically.
+ */
+struct FirmwareBootRecord {
+    uint32_t magic;
+    int8_t active;              // slot to boot, FIRMWARE_SLOT_NONE for none
+    int8_t previous;            // slot to roll back to
+    uint8_t state;
+    uint8_t attempts;           // boots of the active slot while in trial
+    uint32_t size[FIRMWARE_SLOTS];
+    uint8_t sha256[FIRMWARE_SLOTS][32];
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+class LZSSDecoder;
+class DeltaPatch;
+
+/**
+ * Two firmware slots in the image area, after the key-value store. Both the
+ * application and the bootloader are built with the same FLASHER_ADDRESS,
+ * otherwise every function here fails with FIRMWARE_ERROR_LAYOUT and
+ * select_boot_slot() returns FIRMWARE_SLOT_NONE.
+ *
+ * Images run in place from their slot, nothing is copied to the application
+ * area. An image is therefore linked for the slot it goes to, with
+ * target.mbed_app_start set to get_slot_address() of get_inactive_slot(),
+ * and install() refuses an image whose reset vector lies outside the slot.
+ *
+ * An update is written to the slot not in use, e.g. with download(),
+ * download_patch() or a FirmwareUpdate, and handed to install(), which
+ * checks its SHA-256 and makes it the active slot on trial. The bootloader
+ * calls select_boot_address() on every boot and starts the image there;
+ * after FIRMWARE_MAX_TRIAL_BOOTS boots without confirm() from the new
+ * image, or if its hash no longer matches, the previous slot is booted
+ * again, and without one the application itself.
+ */
+class FirmwareSlots{
+    friend class FirmwareUpdate;
+
+private:
+    static int load(FirmwareBootRecord *record);
+    static int store(const FirmwareBootRecord *record);
+    static void roll_back(FirmwareBootRecord *record);
+
+public:
+
+    static uint32_t get_slot_address(int slot);
+    static uint32_t get_slot_size(int slot);
+    static int get_active_slot();
+    static int get_inactive_slot();
+    static int get_state();
+
+    static int download(NetworkInterface *network, const char *url,
+                        const uint8_t sha256[32], const char *sslCaPem = NULL,
+                        bool compressed = false);
+    static int download_patch(NetworkInterface *network, const char *url,
+                              const uint8_t sha256[32], const char *sslCaPem = NULL,
+                              bool compressed = false);
+    static int verify(int slot, uint32_t size, const uint8_t sha256[32]);
+    static int install(int slot, uint32_t size, const uint8_t sha256[32]);
+    static int confirm();
+    static int rollback();
+    static int select_boot_slot();
+    static uint32_t select_boot_address();
+
+};
+
+/**
+ * An update on its way into the inactive slot. It is unpacked if it was
+ * packed with tools/lzss_pack.cpp and rebuilt from the active image if it
+ * is a patch from tools/delta_patch.cpp, as it arrives, so neither the
+ * download nor the image is held in RAM.
+ *
+ * download() fetches it over HTTP. Other transports call begin(), feed()
+ * with the data in order, and finish(), which installs the image.
+ */
+class FirmwareUpdate{
+private:
+    OTAPipeline pipeline;
+    LZSSDecoder *decoder;       // NULL unless the update is packed
+    DeltaPatch *patch;          // NULL unless the update is a patch
+    OTAStage stage;
+    int slot;                   // slot being written, FIRMWARE_SLOT_NONE if none
+
+    int prepare(bool isPatch, bool compressed);
+    void release();
+
+    static int unpacked(void *context, const uint8_t *data, size_t len);
+    static int stage_feed(void *context, const uint8_t *data, size_t len);
+    static int stage_finish(void *context);
+
+public:
+
+    /* Constructors */
+    FirmwareUpdate();
+
+    /* Destructors */
+    ~FirmwareUpdate();
+
+    /* Functions */
+
+    int begin(bool isPatch = false, bool compressed = false);
+    int feed(const void *data, uint32_t len);
+    int finish(const uint8_t sha256[32]);
+    void abort();
+    int download(NetworkInterface *network, const char *url, const char *sslCaPem,
+                 const uint8_t sha256[32], bool isPatch = false, bool compressed = false);
+    bool active();
+
+};
+
+#endif
@@ -0,0 +1,550 @@
+/**
+ ******************************************************************************
+ * @file    FlashKV.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Log-structured key-value store in flash.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FlashKV.h"
+#include "Flasher.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	Constructor.
+ */
+FlashKV::FlashKV(){
+    active = -1;
+    sequence = 0;
+    writePos = 0;
+    count = 0;
+    ready = false;
+}
+
+/** Destructor
+ * @brief	Destructor.
+ */
+FlashKV::~FlashKV(){
+    if(ready){
+        flash.deinit();
+    }
+}
+
+/** init
+ * @brief	Finds the sector in use and indexes its records, or formats
+ *          the store if no sector is valid. Does nothing the second time.
+ * @param	Address of the first sector, 0 for Flasher::get_kv_address()
+ * @return  Return code
+ */
+int FlashKV::init(uint32_t address){
+    mutex.lock();
+    if(ready){
+        mutex.unlock();
+        return 0;
+    }
+
+    flash.init();
+    uint32_t addr = address ? address : Flasher::get_kv_address();
+    for(int i = 0; i < FLASHER_KV_SECTORS; i++){
+        sectorStart[i] = addr;
+        addr += flash.get_sector_size(addr);
+    }
+    sectorStart[FLASHER_KV_SECTORS] = addr;
+
+    uint32_t pageSize = flash.get_page_size();
+    align = pageSize < 4 ? 4 : pageSize;
+    headerSpace = ((sizeof(FlashKVSector) + align - 1) / align) * align;
+
+    // The valid sector with the highest sequence is in use
+    active = -1;
+    for(int i = 0; i < FLASHER_KV_SECTORS; i++){
+        const FlashKVSector *s = (const FlashKVSector *)sectorStart[i];
+        if(s->magic == FLASH_KV_SECTOR_MAGIC &&
+            (active < 0 || (int32_t)(s->sequence - sequence) > 0)){
+            active = i;
+            sequence = s->sequence;
+        }
+    }
+
+    int rc = 0;
+    if(active < 0){
+        rc = format();
+    }
+    if(rc == 0){
+        load();
+        ready = true;
+    }
+    else{
+        flash.deinit();
+    }
+
+    mutex.unlock();
+    return rc;
+}
+
+/** set
+ * @brief	Stores a value, replacing the one stored before under the key.
+ * @param	Key, at most FLASH_KV_MAX_KEY_LEN characters
+ * @param	Value
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int FlashKV::set(const char *key, const void *value, uint32_t len){
+    if(!key || key[0] == '\0' || strlen(key) > FLASH_KV_MAX_KEY_LEN){
+        return FLASH_KV_ERROR_KEY;
+    }
+
+    mutex.lock();
+    if(!ready){
+        mutex.unlock();
+        return FLASH_KV_ERROR_STATE;
+    }
+
+    uint32_t hash = hash_key(key);
+    Entry *e = find(key, hash);
+    if(!e && count == FLASH_KV_MAX_KEYS){
+        mutex.unlock();
+        return FLASH_KV_ERROR_FULL;
+    }
+
+    const FlashKVRecord *record;
+    int rc = append(key, 0, value, len, e, &record);
+    if(rc == 0){
+        // a compaction in append() rebuilds the index
+        e = find(key, hash);
+        if(!e){
+            e = &entries[count++];
+            e->hash = hash;
+        }
+        e->record = record;
+    }
+
+    mutex.unlock();
+    return rc;
+}
+
+/** get
+ * @brief	Looks a key up in the index.
+ * @param	Key
+ * @param	Set to the length of the value
+ * @return  The value in flash, or NULL if the key is not stored
+ */
+const void *FlashKV::get(const char *key, uint32_t *len){
+    if(!key){
+        return NULL;
+    }
+
+    mutex.lock();
+    Entry *e = ready ? find(key, hash_key(key)) : NULL;
+    mutex.unlock();
+
+    if(!e){
+        return NULL;
+    }
+    *len = e->record->valueLen;
+    return value_of(e->record);
+}
+
+/** remove
+ * @brief	Deletes a key.
+ * @param	Key
+ * @return  Return code
+ */
+int FlashKV::remove(const char *key){
+    if(!key){
+        return FLASH_KV_ERROR_KEY;
+    }
+
+    mutex.lock();
+    if(!ready){
+        mutex.unlock();
+        return FLASH_KV_ERROR_STATE;
+    }
+
+    uint32_t hash = hash_key(key);
+    Entry *e = find(key, hash);
+    if(!e){
+        mutex.unlock();
+        return FLASH_KV_ERROR_NOT_FOUND;
+    }
+
+    const FlashKVRecord *record;
+    int rc = append(key, FLASH_KV_FLAG_DELETED, NULL, 0, e, &record);
+    if(rc == 0){
+        e = find(key, hash);
+        if(e){
+            *e = entries[--count];
+        }
+    }
+
+    mutex.unlock();
+    return rc;
+}
+
+/** compact
+ * @brief	Copies the live records to the next sector now, rather than
+ *          when the sector in use is full.
+ * @return  Return code
+ */
+int FlashKV::compact(){
+    mutex.lock();
+    int rc = ready ? compact_to(0, NULL) : FLASH_KV_ERROR_STATE;
+    mutex.unlock();
+    return rc;
+}
+
+/** free_space
+ * @brief	Returns the bytes left in the sector in use.
+ * @return  Number of bytes
+ */
+uint32_t FlashKV::free_space(){
+    return ready ? sectorStart[active + 1] - writePos : 0;
+}
+
+/** keys
+ * @brief	Returns the number of keys stored.
+ * @return  Number of keys
+ */
+int FlashKV::keys(){
+    return count;
+}
+
+/** format
+ * @brief	Starts an empty store in the first sector.
+ * @return  Return code
+ */
+int FlashKV::format(){
+    if(flash.erase(sectorStart[0], sectorStart[1] - sectorStart[0]) != 0){
+        return FLASH_KV_ERROR_ERASE;
+    }
+    int rc = program_header(0, 1);
+    if(rc == 0){
+        active = 0;
+        sequence = 1;
+    }
+    return rc;
+}
+
+/** program_header
+ * @brief	Programs the header that makes an erased or filled sector valid.
+ * @param	Sector index
+ * @param	Sequence
+ * @return  Return code
+ */
+int FlashKV::program_header(int sector, uint32_t seq){
+    uint8_t *buffer = (uint8_t *)malloc(headerSpace);
+    if(!buffer){
+        return FLASH_KV_ERROR_NO_MEMORY;
+    }
+
+    FlashKVSector header;
+    header.magic = FLASH_KV_SECTOR_MAGIC;
+    header.sequence = seq;
+    memset(buffer, 0xFF, headerSpace);
+    memcpy(buffer, &header, sizeof(header));
+
+    int rc = 0;
+    if(flash.program(buffer, sectorStart[sector], headerSpace) != 0){
+        rc = FLASH_KV_ERROR_PROGRAM;
+    }
+    free(buffer);
+    return rc;
+}
+
+/** load
+ * @brief	Walks the records of the sector in use into the index.
+ */
+void FlashKV::load(){
+    uint32_t pos = sectorStart[active] + headerSpace;
+    uint32_t end = sectorStart[active + 1];
+
+    count = 0;
+    while(end - pos >= sizeof(FlashKVRecord)){
+        const FlashKVRecord *r = (const FlashKVRecord *)pos;
+        if(r->magic == 0xFFFFFFFF){
+            break; // erased, the end of the log
+        }
+
+        // A header that does not parse leaves no way to find the next record,
+        // the rest of the sector is skipped until the next compaction
+        if(r->magic != FLASH_KV_RECORD_MAGIC || r->keyLen == 0 ||
+            r->keyLen > FLASH_KV_MAX_KEY_LEN + 1 || r->valueLen > end - pos ||
+            record_length(r->keyLen, r->valueLen) > end - pos){
+            pos = end;
+            break;
+        }
+
+        // A record cut short by a reset fails its CRC and is skipped
+        if(valid(r)){
+            const char *key = (const char *)(r + 1);
+            uint32_t hash = hash_key(key);
+            Entry *e = find(key, hash);
+            if(r->flags & FLASH_KV_FLAG_DELETED){
+                if(e){
+                    *e = entries[--count];
+                }
+            }
+            else if(e){
+                e->record = r;
+            }
+            else if(count < FLASH_KV_MAX_KEYS){
+                entries[count].hash = hash;
+                entries[count].record = r;
+                count++;
+            }
+        }
+        pos += record_length(r->keyLen, r->valueLen);
+    }
+    writePos = pos;
+}
+
+/** append
+ * @brief	Programs a record at the end of the log, compacting first if it
+ *          does not fit.
+ * @param	Key
+ * @param	Flags
+ * @param	Value
+ * @param	Length in bytes
+ * @param	Index entry the record replaces, not copied by a compaction
+ * @param	Set to the record in flash
+ * @return  Return code
+ */
+int FlashKV::append(const char *key, uint16_t flags, const void *value, uint32_t len,
+                    const Entry *replaced, const FlashKVRecord **record){
+    uint32_t keyLen = strlen(key) + 1;
+    uint32_t total = record_length(keyLen, len);
+
+    if(total > sectorStart[active + 1] - writePos){
+        // The record goes into the new sector with the copies, so the key
+        // is never missing from the live sector, not even after a reset
+        return compact_to(total, replaced, key, flags, value, len, record);
+    }
+
+    FlashWriter writer;
+    int rc = writer.open(writePos, sectorStart[active + 1], true);
+    if(rc == 0){
+        rc = write_record(&writer, key, flags, value, len);
+    }
+    if(rc == 0){
+        rc = writer.commit();
+    }
+    else{
+        writer.close();
+    }
+
+    if(rc != 0){
+        // what was programmed is unknown, fill the sector up so the next
+        // write starts a new one
+        writePos = sectorStart[active + 1];
+        return rc;
+    }
+
+    *record = (const FlashKVRecord *)writePos;
+    writePos += total;
+    return 0;
+}
+
+/** write_record
+ * @brief	Writes a record with its padding, without committing it.
+ * @param	Writer
+ * @param	Key
+ * @param	Flags
+ * @param	Value
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int FlashKV::write_record(FlashWriter *writer, const char *key, uint16_t flags, const void *value, uint32_t len){
+    static const uint8_t erased[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    uint32_t keyLen = strlen(key) + 1;
+
+    FlashKVRecord header;
+    header.magic = FLASH_KV_RECORD_MAGIC;
+    header.keyLen = keyLen;
+    header.flags = flags;
+    header.valueLen = len;
+    header.crc = FlashRecord::crc32(0, &header.keyLen, sizeof(header) - offsetof(FlashKVRecord, keyLen));
+    header.crc = FlashRecord::crc32(header.crc, key, keyLen);
+    header.crc = FlashRecord::crc32(header.crc, value, len);
+
+    int rc = writer->write(&header, sizeof(header));
+    if(rc == 0){
+        rc = writer->write(key, keyLen);
+    }
+    if(rc == 0){
+        rc = writer->write(erased, (4 - keyLen % 4) % 4);
+    }
+    if(rc == 0 && len > 0){
+        rc = writer->write(value, len);
+    }
+    if(rc == 0){
+        rc = writer->write(erased, (4 - len % 4) % 4);
+    }
+    return rc;
+}
+
+/** compact_to
+ * @brief	Copies the latest record of every key into the next sector,
+ *          followed by a new record, and switches to it once its header is
+ *          programmed.
+ * @param	Bytes that must be free afterwards
+ * @param	Index entry not to copy
+ * @param	Key of the new record, NULL for none
+ * @param	Flags of the new record, a deletion is not written as the
+ *          skipped entry is gone already
+ * @param	Value of the new record
+ * @param	Length in bytes
+ * @param	Set to the new record in flash
+ * @return  Return code
+ */
+int FlashKV::compact_to(uint32_t needed, const Entry *skip, const char *key, uint16_t flags,
+                        const void *value, uint32_t len, const FlashKVRecord **record){
+    int target = (active + 1) % FLASHER_KV_SECTORS;
+    uint32_t start = sectorStart[target];
+    uint32_t end = sectorStart[target + 1];
+
+    uint32_t live = headerSpace + needed;
+    for(int i = 0; i < count; i++){
+        if(&entries[i] != skip){
+            live += record_length(entries[i].record->keyLen, entries[i].record->valueLen);
+        }
+    }
+    if(live > end - start){
+        return FLASH_KV_ERROR_FULL;
+    }
+
+    if(flash.erase(start, end - start) != 0){
+        return FLASH_KV_ERROR_ERASE;
+    }
+
+    // Records are valid as they are, including their padding
+    FlashWriter writer;
+    int rc = writer.open(start + headerSpace, end, true);
+    for(int i = 0; i < count && rc == 0; i++){
+        if(&entries[i] != skip){
+            const FlashKVRecord *r = entries[i].record;
+            rc = writer.write(r, record_length(r->keyLen, r->valueLen));
+        }
+    }
+    uint32_t recordPos = writer.get_address();
+    if(rc == 0 && key && !(flags & FLASH_KV_FLAG_DELETED)){
+        rc = write_record(&writer, key, flags, value, len);
+    }
+    if(rc == 0){
+        rc = writer.commit();
+    }
+    else{
+        writer.close();
+    }
+
+    // Until the header is programmed the old sector stays in use
+    if(rc == 0){
+        rc = program_header(target, sequence + 1);
+    }
+    if(rc != 0){
+        return rc;
+    }
+
+    active = target;
+    sequence++;
+    load();
+    if(record){
+        *record = (const FlashKVRecord *)recordPos;
+    }
+    return 0;
+}
+
+/** find
+ * @brief	Looks a key up in the index.
+ * @param	Key
+ * @param	Hash of the key
+ * @return  Index entry, or NULL
+ */
+FlashKV::Entry *FlashKV::find(const char *key, uint32_t hash){
+    for(int i = 0; i < count; i++){
+        if(entries[i].hash == hash && strcmp((const char *)(entries[i].record + 1), key) == 0){
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+/** record_length
+ * @brief	Returns the flash space a record takes.
+ * @param	Key length with the NUL
+ * @param	Value length
+ * @return  Number of bytes
+ */
+uint32_t FlashKV::record_length(uint32_t keyLen, uint32_t valueLen){
+    uint32_t len = sizeof(FlashKVRecord) + ((keyLen + 3) & ~3) + valueLen;
+    return ((len + align - 1) / align) * align;
+}
+
+/** hash_key
+ * @brief	FNV-1a hash of a key.
+ * @param	Key
+ * @return  Hash
+ */
+uint32_t FlashKV::hash_key(const char *key){
+    uint32_t hash = 2166136261u;
+    while(*key){
+        hash = (hash ^ (uint8_t)*key++) * 16777619u;
+    }
+    return hash;
+}
+
+/** valid
+ * @brief	Checks the key termination and the CRC of a record.
+ * @param	Record
+ * @return  True if the record is intact
+ */
+bool FlashKV::valid(const FlashKVRecord *record){
+    const char *key = (const char *)(record + 1);
+    if(key[record->keyLen - 1] != '\0'){
+        return false;
+    }
+
+    uint32_t crc = FlashRecord::crc32(0, &record->keyLen, sizeof(FlashKVRecord) - offsetof(FlashKVRecord, keyLen));
+    crc = FlashRecord::crc32(crc, key, record->keyLen);
+    crc = FlashRecord::crc32(crc, value_of(record), record->valueLen);
+    return crc == record->crc;
+}
+
+/** value_of
+ * @brief	Returns the value of a record, after its padded key.
+ * @param	Record
+ * @return  Value
+ */
+const uint8_t *FlashKV::value_of(const FlashKVRecord *record){
+    return (const uint8_t *)(record + 1) + ((record->keyLen + 3) & ~3);
+}
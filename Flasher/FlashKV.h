@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ * @file    FlashKV.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Log-structured key-value store in flash.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _FLASH_KV_H
+#define _FLASH_KV_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "FlashWriter.h"
+#include "FlashRecord.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+/* Sectors the store rotates through, at least 2 */
+#ifndef FLASHER_KV_SECTORS
+#define FLASHER_KV_SECTORS 2
+#endif
+
+#if FLASHER_KV_SECTORS < 2
+#error "FLASHER_KV_SECTORS must be at least 2"
+#endif
+
+#ifndef FLASH_KV_MAX_KEYS
+#define FLASH_KV_MAX_KEYS      16    // entries in the RAM index
+#endif
+
+#define FLASH_KV_MAX_KEY_LEN   32    // bytes, without the NUL
+
+#define FLASH_KV_SECTOR_MAGIC  0x534B564C // "LVKS"
+#define FLASH_KV_RECORD_MAGIC  0x524B564C // "LVKR"
+
+#define FLASH_KV_FLAG_DELETED  0x0001
+
+#define FLASH_KV_ERROR_ERASE       FLASH_WRITER_ERROR_ERASE
+#define FLASH_KV_ERROR_PROGRAM     FLASH_WRITER_ERROR_PROGRAM
+#define FLASH_KV_ERROR_TOO_LARGE   FLASH_WRITER_ERROR_TOO_LARGE
+#define FLASH_KV_ERROR_STATE       FLASH_WRITER_ERROR_STATE
+#define FLASH_KV_ERROR_NO_MEMORY   FLASH_WRITER_ERROR_NO_MEMORY
+#define FLASH_KV_ERROR_FULL        8
+#define FLASH_KV_ERROR_NOT_FOUND   9
+#define FLASH_KV_ERROR_KEY         10
+
+/**
+ * Starts the first page(s) of a sector, programmed after the records
+ * copied into it, so a sector only counts once compaction has finished.
+ */
+struct FlashKVSector {
+    uint32_t magic;
+    uint32_t sequence;          // the valid sector with the highest one is in use
+};
+
+/**
+ * Starts every record, followed by the NUL terminated key padded to 4 bytes
+ * and the value. Records start on a page, and 4 byte, boundary.
+ */
+struct FlashKVRecord {
+    uint32_t magic;
+    uint32_t crc;               // CRC32 of keyLen, flags, valueLen, key and value
+    uint16_t keyLen;            // with the NUL
+    uint16_t flags;
+    uint32_t valueLen;
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Key-value store that appends records to flash instead of rewriting them.
+ *
+ * set() and remove() program one record at the end of the sector in use,
+ * which takes milliseconds instead of a sector erase. When the sector is
+ * full the latest record of every key is copied to the next sector, round
+ * robin over FLASHER_KV_SECTORS sectors, so erases are spread over all of
+ * them. A RAM index of the latest records is built by init().
+ *
+ * get() returns a pointer into the memory mapped flash, valid until the
+ * next set() or remove().
+ */
+class FlashKV{
+private:
+    struct Entry {
+        uint32_t hash;
+        const FlashKVRecord *record;
+    };
+
+    FlashIAP flash;
+    Mutex mutex;
+    uint32_t sectorStart[FLASHER_KV_SECTORS + 1];   // the last one is the end
+    uint32_t align;             // record alignment
+    uint32_t headerSpace;       // bytes reserved for the FlashKVSector
+    int active;
+    uint32_t sequence;
+    uint32_t writePos;
+    bool ready;
+
+    Entry entries[FLASH_KV_MAX_KEYS];
+    int count;
+
+    int format();
+    int program_header(int sector, uint32_t seq);
+    void load();
+    int append(const char *key, uint16_t flags, const void *value, uint32_t len,
+               const Entry *replaced, const FlashKVRecord **record);
+    int compact_to(uint32_t needed, const Entry *skip, const char *key = NULL, uint16_t flags = 0,
+                   const void *value = NULL, uint32_t len = 0, const FlashKVRecord **record = NULL);
+    int write_record(FlashWriter *writer, const char *key, uint16_t flags, const void *value, uint32_t len);
+    Entry *find(const char *key, uint32_t hash);
+    uint32_t record_length(uint32_t keyLen, uint32_t valueLen);
+
+    static uint32_t hash_key(const char *key);
+    static bool valid(const FlashKVRecord *record);
+    static const uint8_t *value_of(const FlashKVRecord *record);
+
+public:
+
+    FlashKV();
+    ~FlashKV();
+
+    int init(uint32_t address = 0);
+    int set(const char *key, const void *value, uint32_t len);
+    const void *get(const char *key, uint32_t *len);
+    int remove(const char *key);
+    int compact();
+    uint32_t free_space();
+    int keys();
+
+};
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ * @file    FlashRecord.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Length and CRC framed records in flash.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FlashRecord.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** record_crc
+ * @brief	CRC of a record: the data, then the length and the sequence.
+ * @param	Data
+ * @param	Length in bytes
+ * @param	Sequence
+ * @return  CRC
+ */
+static uint32_t record_crc(const void *data, uint32_t length, uint32_t sequence){
+    uint32_t crc = FlashRecord::crc32(0, data, length);
+    crc = FlashRecord::crc32(crc, &length, sizeof(length));
+    return FlashRecord::crc32(crc, &sequence, sizeof(sequence));
+}
+
+/** write
+ * @brief	Writes a header and the data through an open writer.
+ * @param	Writer, positioned on a 4 byte boundary
+ * @param	Sequence
+ * @param	Data
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int FlashRecord::write(FlashWriter &writer, uint32_t sequence, const void *data, uint32_t length){
+    FlashRecordHeader header;
+    header.magic = FLASH_RECORD_MAGIC;
+    header.length = length;
+    header.crc = record_crc(data, length, sequence);
+    header.sequence = sequence;
+
+    int rc = writer.write(&header, sizeof(header));
+    if(rc == 0 && length > 0){
+        rc = writer.write(data, length);
+    }
+    return rc;
+}
+
+/** read
+ * @brief	Validates the record at an address in memory mapped flash.
+ * @param	Address of the header
+ * @param	End of the area the record must fit in
+ * @param	Set to the data length
+ * @param	Set to the sequence, unless NULL
+ * @return  The data in flash, or NULL if there is no intact record
+ */
+const void *FlashRecord::read(uint32_t address, uint32_t end, uint32_t *length, uint32_t *sequence){
+    const FlashRecordHeader *header = (const FlashRecordHeader *)address;
+
+    if(end - address < sizeof(FlashRecordHeader) || header->magic != FLASH_RECORD_MAGIC ||
+        header->length > end - address - sizeof(FlashRecordHeader)){
+        return NULL;
+    }
+
+    const void *data = header + 1;
+    if(record_crc(data, header->length, header->sequence) != header->crc){
+        return NULL;
+    }
+
+    *length = header->length;
+    if(sequence){
+        *sequence = header->sequence;
+    }
+    return data;
+}
+
+/** crc32
+ * @brief	CRC-32 (IEEE 802.3) over a buffer, chained through the first argument.
+ * @param	CRC of the preceding data, 0 to start
+ * @param	Data
+ * @param	Length in bytes
+ * @return  CRC
+ */
+uint32_t FlashRecord::crc32(uint32_t crc, const void *data, uint32_t len){
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    while(len--){
+        crc = table[(crc ^ *p) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (*p >> 4)) & 0x0F] ^ (crc >> 4);
+        p++;
+    }
+    return ~crc;
+}
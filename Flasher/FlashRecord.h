@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * @file    FlashRecord.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Length and CRC framed records in flash.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _FLASH_RECORD_H
+#define _FLASH_RECORD_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "FlashWriter.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+#define FLASH_RECORD_MAGIC  0x43524C46 // "FLRC"
+
+/**
+ * Precedes the data of a record. The data follows on a 4 byte boundary,
+ * so a stored struct can be used in place.
+ */
+struct FlashRecordHeader {
+    uint32_t magic;
+    uint32_t length;            // data bytes
+    uint32_t crc;               // CRC32 of the data, then length and sequence
+    uint32_t sequence;          // incremented by every write of the record
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Frames a blob in flash so it can be read back in place: a reader checks
+ * the header and the CRC and gets a pointer and a length, with no scan for
+ * a terminator and no copy.
+ */
+class FlashRecord{
+public:
+
+    static int write(FlashWriter &writer, uint32_t sequence, const void *data, uint32_t length);
+    static const void *read(uint32_t address, uint32_t end, uint32_t *length, uint32_t *sequence = NULL);
+    static uint32_t crc32(uint32_t crc, const void *data, uint32_t len);
+
+};
+
+#endif
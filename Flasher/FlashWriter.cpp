@@ -0,0 +1,275 @@
+/**
+ ******************************************************************************
+ * @file    FlashWriter.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Streaming flash writer across pages and sectors.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FlashWriter.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	Constructor.
+ */
+FlashWriter::FlashWriter(){
+    pageBuffer = NULL;
+    pageSize = 0;
+    pageFill = 0;
+    start = 0;
+    end = 0;
+    address = 0;
+    erasedEnd = 0;
+    opened = false;
+}
+
+/** Destructor
+ * @brief	Destructor, drops an uncommitted partial page.
+ */
+FlashWriter::~FlashWriter(){
+    close();
+}
+
+/** open
+ * @brief	Starts writing a region. Nothing is erased until it is written.
+ * @param	Start address, at the start of a sector unless erased is set
+ * @param	End address, the region stops at the last whole sector below it,
+ *          or the last whole page when erased is set
+ * @param	Whether the region is already erased, e.g. the unused tail of a
+ *          log, then the start only has to be page aligned
+ * @return  Return code
+ */
+int FlashWriter::open(uint32_t addr, uint32_t endAddr, bool erased){
+    if(opened){
+        return FLASH_WRITER_ERROR_STATE;
+    }
+
+    flash.init();
+    pageSize = flash.get_page_size();
+    if(addr % (erased ? pageSize : flash.get_sector_size(addr)) != 0){
+        flash.deinit();
+        return FLASH_WRITER_ERROR_ALIGNMENT;
+    }
+
+    if(erased){
+        endAddr -= endAddr % pageSize;
+    }
+    else{
+        // erase_ahead() erases whole sectors, none may reach past the end
+        uint32_t sectorEnd = addr;
+        while(sectorEnd < endAddr){
+            uint32_t size = flash.get_sector_size(sectorEnd);
+            if(size == 0 || size > endAddr - sectorEnd){
+                break;
+            }
+            sectorEnd += size;
+        }
+        endAddr = sectorEnd;
+    }
+    if(addr >= endAddr){
+        flash.deinit();
+        return FLASH_WRITER_ERROR_TOO_LARGE;
+    }
+
+    pageBuffer = (uint8_t *)malloc(pageSize);
+    if(!pageBuffer){
+        flash.deinit();
+        return FLASH_WRITER_ERROR_NO_MEMORY;
+    }
+
+    start = addr;
+    end = endAddr;
+    address = addr;
+    erasedEnd = erased ? endAddr : addr;
+    pageFill = 0;
+    opened = true;
+    return 0;
+}
+
+/** write
+ * @brief	Appends data to the region.
+ * @param	Data
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int FlashWriter::write(const void *data, uint32_t len){
+    const uint8_t *p = (const uint8_t *)data;
+    int rc;
+
+    if(!opened){
+        return FLASH_WRITER_ERROR_STATE;
+    }
+    if(len > end - address - pageFill){
+        return FLASH_WRITER_ERROR_TOO_LARGE;
+    }
+
+    // Complete the partial page from the last write first
+    if(pageFill > 0){
+        uint32_t n = pageSize - pageFill;
+        if(n > len){
+            n = len;
+        }
+        memcpy(pageBuffer + pageFill, p, n);
+        pageFill += n;
+        p += n;
+        len -= n;
+
+        if(pageFill < pageSize){
+            return 0;
+        }
+        rc = program(pageBuffer, pageSize);
+        if(rc != 0){
+            return rc;
+        }
+        pageFill = 0;
+    }
+
+    // Whole pages in a single program call
+    uint32_t whole = len - (len % pageSize);
+    if(whole > 0){
+        rc = program(p, whole);
+        if(rc != 0){
+            return rc;
+        }
+        p += whole;
+        len -= whole;
+    }
+
+    // Keep the tail for the next write
+    memcpy(pageBuffer, p, len);
+    pageFill = len;
+    return 0;
+}
+
+/** erase_ahead
+ * @brief	Erases sectors until everything below an address is erased, so
+ *          a later write does not have to wait for it.
+ * @param	Address
+ * @return  Return code
+ */
+int FlashWriter::erase_ahead(uint32_t upTo){
+    if(!opened){
+        return FLASH_WRITER_ERROR_STATE;
+    }
+    while(erasedEnd < upTo && erasedEnd < end){
+        uint32_t size = flash.get_sector_size(erasedEnd);
+        if(flash.erase(erasedEnd, size) != 0){
+            return FLASH_WRITER_ERROR_ERASE;
+        }
+        erasedEnd += size;
+    }
+    return 0;
+}
+
+/** commit
+ * @brief	Pads and programs the partial page, then closes the writer.
+ * @return  Return code
+ */
+int FlashWriter::commit(){
+    int rc = 0;
+
+    if(!opened){
+        return FLASH_WRITER_ERROR_STATE;
+    }
+    if(pageFill > 0){
+        memset(pageBuffer + pageFill, 0xFF, pageSize - pageFill);
+        rc = program(pageBuffer, pageSize);
+    }
+    close();
+    return rc;
+}
+
+/** close
+ * @brief	Closes the writer without programming the partial page.
+ */
+void FlashWriter::close(){
+    if(!opened){
+        return;
+    }
+    free(pageBuffer);
+    pageBuffer = NULL;
+    pageFill = 0;
+    flash.deinit();
+    opened = false;
+}
+
+/** written
+ * @brief	Returns the number of bytes written since open().
+ * @return  Number of bytes
+ */
+uint32_t FlashWriter::written(){
+    return address - start + pageFill;
+}
+
+/** capacity
+ * @brief	Returns the size of the region.
+ * @return  Number of bytes
+ */
+uint32_t FlashWriter::capacity(){
+    return end - start;
+}
+
+/** get_address
+ * @brief	Returns the address the next byte is written to.
+ * @return  Address
+ */
+uint32_t FlashWriter::get_address(){
+    return address + pageFill;
+}
+
+/** get_page_size
+ * @brief	Returns the program page size, valid after open().
+ * @return  Page size in bytes
+ */
+uint32_t FlashWriter::get_page_size(){
+    return pageSize;
+}
+
+/** program
+ * @brief	Programs whole pages at the write address, erasing first.
+ * @param	Data
+ * @param	Size in bytes, a multiple of the page size
+ * @return  Return code
+ */
+int FlashWriter::program(const void *data, uint32_t size){
+    int rc = erase_ahead(address + size);
+    if(rc != 0){
+        return rc;
+    }
+    if(flash.program(data, address, size) != 0){
+        return FLASH_WRITER_ERROR_PROGRAM;
+    }
+    address += size;
+    return 0;
+}
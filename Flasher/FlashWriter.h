@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file    FlashWriter.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Streaming flash writer across pages and sectors.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _FLASH_WRITER_H
+#define _FLASH_WRITER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+#define FLASH_WRITER_ERROR_ERASE       1
+#define FLASH_WRITER_ERROR_PROGRAM     2
+#define FLASH_WRITER_ERROR_TOO_LARGE   3
+#define FLASH_WRITER_ERROR_STATE       4
+#define FLASH_WRITER_ERROR_NO_MEMORY   6
+#define FLASH_WRITER_ERROR_ALIGNMENT   7
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Writes a blob of any size to a flash region in pieces.
+ *
+ * Sectors are erased just before the first page in them is programmed.
+ * Whole pages are programmed straight from the caller's buffer, a trailing
+ * partial page is kept until the next write() completes it or commit()
+ * pads it with the erased value.
+ */
+class FlashWriter{
+private:
+    FlashIAP flash;
+    uint8_t *pageBuffer;
+    uint32_t pageSize;
+    uint32_t pageFill;          // bytes waiting in pageBuffer
+
+    uint32_t start;
+    uint32_t end;
+    uint32_t address;           // where the next page is programmed
+    uint32_t erasedEnd;         // everything below is erased
+    bool opened;
+
+    int program(const void *data, uint32_t size);
+
+public:
+
+    FlashWriter();
+    ~FlashWriter();
+
+    int open(uint32_t start, uint32_t end, bool erased = false);
+    int write(const void *data, uint32_t len);
+    int erase_ahead(uint32_t upTo);
+    int commit();
+    void close();
+    uint32_t written();
+    uint32_t capacity();
+    uint32_t get_address();
+    uint32_t get_page_size();
+
+};
+
+#endif
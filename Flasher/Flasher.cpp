@@ -41,6 +41,7 @@
 /* Class Implementation ------------------------------------------------------*/
 
 FlashIAP Flasher::flash;
+FlashKV Flasher::kv;
 
 /** Constructor
  * @brief	Constructor.
@@ -57,11 +58,11 @@ Flasher::~Flasher(){
 }
 
 /** get_flash_address
- * @brief	Returns the flash start address.
+ * @brief	Returns the flash start address, FLASHER_ADDRESS if it is set.
  * @return  Start address
  */
 uint32_t Flasher::get_flash_address(){
-    uint32_t address = POST_APPLICATION_ADDR;
+    uint32_t address = FLASHER_ADDRESS ? FLASHER_ADDRESS : POST_APPLICATION_ADDR;
 
     // Get start address
     // Way 1, start from the beginnning and keep going until we find a sector
@@ -82,6 +83,38 @@ uint32_t Flasher::get_flash_address(){
     return addr;
 }
     
+/** get_kv_address
+ * @brief	Returns the address of the key-value store, after the data sectors.
+ * @return  Store address
+ */
+uint32_t Flasher::get_kv_address(){
+    uint32_t addr = get_flash_address();
+    for(int i = 0; i < FLASHER_DATA_SECTORS; i++){
+        addr += flash.get_sector_size(addr);
+    }
+    return addr;
+}
+
+/** get_image_address
+ * @brief	Returns the address of the firmware image, after the key-value store.
+ * @return  Image address
+ */
+uint32_t Flasher::get_image_address(){
+    uint32_t addr = get_kv_address();
+    for(int i = 0; i < FLASHER_KV_SECTORS; i++){
+        addr += flash.get_sector_size(addr);
+    }
+    return addr;
+}
+
+/** get_flash_end
+ * @brief	Returns the address just past the end of the flash.
+ * @return  End address
+ */
+uint32_t Flasher::get_flash_end(){
+    return flash.get_flash_start() + flash.get_flash_size();
+}
+
 /** erase_flash
  * @brief	Erases theflash.
  * @return  Return code
@@ -107,124 +140,94 @@ int Flasher::write_to_flash(string buffer){
 }
 
 /** write_to_flash
- * @brief	Writes char pointer to flash.
+ * @brief	Writes a string to flash, with its terminating NUL.
+ * @param	data
  * @return  Return code
  */
 int Flasher::write_to_flash(char *data){
-    //printf("Flashing: %s\r\nLength: %i\r\n", data, strlen(data));
-      
-    flash.init();
-    
-    uint32_t addr = get_flash_address();
-    //uint32_t next_sector = addr + flash.get_sector_size(addr);
-    //size_t pages_flashed = 0;
-    //uint32_t percent_done = 0;
-    bool sector_erased = false;
-    
-    while (true) {
+    return write_to_flash((const void *)data, strlen(data) + 1);
+}
 
-        // Read data for this page
-        /*
-        memset(page_buffer, 0, sizeof(page_buffer));
-        int size_read = fread(page_buffer, 1, page_size, file);
-        if (size_read <= 0) {
-            break;
-        }
-        */
+/** write_to_flash
+ * @brief	Writes a binary buffer to the data sectors as one record.
+ * @param	data
+ * @param	size in bytes, at most the FLASHER_DATA_SECTORS sectors less
+ *          the record header
+ * @return  Return code
+ */
+int Flasher::write_to_flash(const void *data, uint32_t size){
+    FlashWriter writer;
+    uint32_t length;
+    uint32_t sequence = 0;
 
-        // Erase this page if it hasn't been erased
-        if (!sector_erased) {
-            if(flash.erase(addr, flash.get_sector_size(addr)) != 0){
-                //printf("Error erasing Flash...\n");
-                flash.deinit();
-                return 1; // Error while erasing
-            }
-            printf("Erased Flash...\n");
-            sector_erased = true;
-        }
+    // Carry the sequence on, so a reader can tell a rewrite from the old data
+    read_from_flash(&length, &sequence);
 
-        // Program page
-        if(flash.program(data, addr, flash.get_page_size()) != 0){
-            //printf("Error Flashing...\n");
-            flash.deinit();
-            return 2; // Error while flashing
-        }
+    int rc = writer.open(get_flash_address(), get_kv_address());
+    if(rc != 0){
+        return rc;
+    }
 
-        printf("Flashed %i bytes\n", strlen(data));
-    
-        // Multiple sector write support. Not implemented yet
-        /*
-        addr += page_size;
-        if (addr >= next_sector) {
-            next_sector = addr + flash.get_sector_size(addr);
-            sector_erased = false;
-        }
-        */
-        /*
-        if (++pages_flashed % 3 == 0) {
-            uint32_t percent_done_new = ftell(file) * 100 / len;
-            if (percent_done != percent_done_new) {
-                percent_done = percent_done_new;
-                printf("Flashed %3ld%%\r", percent_done);
-            }
-        }
-        */
-        flash.deinit();
-        break;
-        
+    // The first sector is erased even for an empty buffer, so the old data is gone
+    rc = writer.erase_ahead(get_flash_address() + 1);
+    if(rc == 0){
+        rc = FlashRecord::write(writer, sequence + 1, data, size);
     }
-    
-    //char *data_check;
-    //read_from_flash(data_check);
-    //delete[] page_buffer;
-    return 0;
+    if(rc != 0){
+        writer.close();
+        return rc; // 1 erasing, 2 flashing, 3 does not fit
+    }
+    return writer.commit();
 }
 
 /** read_from_flash
- * @brief	Reads data from flash.
- * @return  Data
+ * @brief	Reads the string stored by write_to_flash().
+ * @return  Data, or 0 if there is no intact string
  */
 char *Flasher::read_from_flash(){
-    //uint32_t address = POST_APPLICATION_ADDR;
-    char *data = (char *)get_flash_address();
-    if((int)data[0] == 255){
+    uint32_t length;
+    const char *data = (const char *)read_from_flash(&length);
+    if(!data || length == 0 || data[length - 1] != '\0'){
         return 0;
     }
-    return data;
+    return (char *)data;
 }
 
+/** read_from_flash
+ * @brief	Returns the data stored by write_to_flash() in place, after
+ *          checking its length and CRC.
+ * @param	Set to the length in bytes
+ * @param	Set to the number of writes so far, unless NULL
+ * @return  Data in flash, or NULL if there is no intact record
+ */
+const void *Flasher::read_from_flash(uint32_t *length, uint32_t *sequence){
+    return FlashRecord::read(get_flash_address(), get_kv_address(), length, sequence);
+}
+
+/** get_kv
+ * @brief	Returns the key-value store, initialised on the first call.
+ * @return  Store, or NULL if it cannot be initialised
+ */
+FlashKV *Flasher::get_kv(){
+    if(kv.init() != 0){
+        return NULL;
+    }
+    return &kv;
+}
 
 /** print_flash
  * @brief	Print the data in flash to terminal.
  * @return  Return code
  */
 int Flasher::print_flash(){
-    uint32_t address = get_flash_address();
-    char *data = (char *)address;
-    
-    flash.init();
-    
-    if(flash.read(data, address, flash.get_page_size()) != 0){
-        //printf("Error reading Flash...\n");
-        flash.deinit();
-        return 1; // Error reading
-    }
+    uint32_t length;
+    const char *data = (const char *)read_from_flash(&length);
 
-    if((int)data[0] == 255){
-        //printf("No data exists in flash...\n");
-        flash.deinit();
-        return 2; // No data exists 
-    }
-
-    printf("Data: ");
-    for(int i = 0; data[i] != '\0'; i++){
-        //printf("%c", *((char *) (address+i)));
-        printf("%c", data[i]);
+    if(!data){
+        return 2; // No data exists
     }
-    printf("\n");
 
-    flash.deinit();
-        
+    printf("Data: %.*s\n", (int)length, data);
     return 0;
 }
 
@@ -43,11 +43,32 @@
 
 #include "mbed.h"
 #include "inttypes.h"
+#include "FlashWriter.h"
+#include "FlashKV.h"
+#include "FlashRecord.h"
 
 
 #include <string>
 using namespace std;
 
+/* Constants -----------------------------------------------------------------*/
+
+/* Start of the Flasher region. The bootloader and the application must find
+ * the key-value store and the firmware slots at the same address, so set it
+ * to the same sector address in both builds, e.g. in target.macros_add of
+ * mbed_app.json. 0 places the region at the first sector from
+ * POST_APPLICATION_ADDR, which only holds in the application build */
+#ifndef FLASHER_ADDRESS
+#define FLASHER_ADDRESS 0
+#endif
+
+/* Sectors at the start of the Flasher region that hold data (write_to_flash),
+ * followed by the FLASHER_KV_SECTORS of the key-value store, a firmware image
+ * is written after them */
+#ifndef FLASHER_DATA_SECTORS
+#define FLASHER_DATA_SECTORS 1
+#endif
+
 /* Class Declaration ---------------------------------------------------------*/
 
 /**
@@ -56,6 +77,7 @@ using namespace std;
 class Flasher{
 private:
     static FlashIAP flash;
+    static FlashKV kv;
 
 public:
 
@@ -63,11 +85,17 @@ public:
     ~Flasher();
     
     static uint32_t get_flash_address();
+    static uint32_t get_kv_address();
+    static uint32_t get_image_address();
+    static uint32_t get_flash_end();
     static int erase_flash();
     static int write_to_flash(char *data);
     static int write_to_flash(string);
+    static int write_to_flash(const void *data, uint32_t size);
     static char *read_from_flash();
+    static const void *read_from_flash(uint32_t *length, uint32_t *sequence = NULL);
     static int print_flash();
+    static FlashKV *get_kv();
 
 };
 
@@ -0,0 +1,410 @@
+/**
+ ******************************************************************************
+ * @file    OTAPipeline.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Firmware download written to flash while it is received.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "OTAPipeline.h"
+#include "http_request.h"
+#include "https_request.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	Constructor.
+ */
+OTAPipeline::OTAPipeline() : freeBuffers(OTA_BUFFERS), fullBuffers(0){
+    for(int i = 0; i < OTA_BUFFERS; i++){
+        buffers[i].data = NULL;
+        buffers[i].len = 0;
+    }
+    writer = NULL;
+    stage = NULL;
+    filling = false;
+    running = false;
+    received = 0;
+    downloaded = 0;
+    error = 0;
+}
+
+/** Destructor
+ * @brief	Destructor.
+ */
+OTAPipeline::~OTAPipeline(){
+    if(running){
+        abort();
+    }
+}
+
+/** begin
+ * @brief	Erases the first sector and starts the writer thread.
+ * @param	Address of the image, 0 for Flasher::get_image_address()
+ * @param	Maximum image size in bytes, 0 for up to the end of the flash.
+ *          The region is cut to whole sectors, so nothing past it is erased
+ * @return  Return code
+ */
+int OTAPipeline::begin(uint32_t addr, uint32_t maxSize){
+    if(running){
+        return OTA_ERROR_STATE;
+    }
+
+    uint32_t start = addr ? addr : Flasher::get_image_address();
+    uint32_t end = Flasher::get_flash_end();
+    if(maxSize && start + maxSize < end){
+        end = start + maxSize;
+    }
+    int rc = image.open(start, end);
+    if(rc != 0){
+        return rc;
+    }
+
+    uint32_t pageSize = image.get_page_size();
+    bufferSize = ((OTA_BUFFER_SIZE + pageSize - 1) / pageSize) * pageSize;
+    for(int i = 0; i < OTA_BUFFERS; i++){
+        buffers[i].data = (uint8_t *)malloc(bufferSize);
+        buffers[i].len = 0;
+        if(!buffers[i].data){
+            release_buffers();
+            image.close();
+            return OTA_ERROR_NO_MEMORY;
+        }
+    }
+
+    fill = 0;
+    drain = 0;
+    received = 0;
+    downloaded = 0;
+    error = 0;
+
+    // the first buffer cannot wait for the writer to erase ahead
+    rc = image.erase_ahead(start + 1);
+    if(rc != 0){
+        release_buffers();
+        image.close();
+        return rc;
+    }
+
+    writer = new Thread(osPriorityNormal, 1024);
+    if(writer->start(callback(this, &OTAPipeline::writer_thread)) != osOK){
+        delete writer;
+        writer = NULL;
+        release_buffers();
+        image.close();
+        return OTA_ERROR_STATE;
+    }
+    running = true;
+    return 0;
+}
+
+/** feed
+ * @brief	Queues the next part of the image. Blocks while both buffers
+ *          wait for the flash.
+ * @param	Data
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int OTAPipeline::feed(const void *data, uint32_t len){
+    const uint8_t *p = (const uint8_t *)data;
+
+    if(!running){
+        return OTA_ERROR_STATE;
+    }
+
+    while(len > 0 && error == 0){
+        if(!filling){
+            freeBuffers.wait();
+            filling = true;
+            continue;
+        }
+
+        Buffer &b = buffers[fill];
+        uint32_t n = bufferSize - b.len;
+        if(n > len){
+            n = len;
+        }
+        if(received + n > image.capacity()){
+            error = OTA_ERROR_TOO_LARGE;
+            break;
+        }
+
+        memcpy(b.data + b.len, p, n);
+        b.len += n;
+        received += n;
+        p += n;
+        len -= n;
+
+        if(b.len == bufferSize){
+            submit();
+        }
+    }
+    return error;
+}
+
+/** receive
+ * @brief	Queues the next part of the download, through the stage if
+ *          there is one.
+ * @param	Data
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int OTAPipeline::receive(const void *data, uint32_t len){
+    if(!stage){
+        return feed(data, len);
+    }
+    if(error == 0 && stage->feed(stage->context, (const uint8_t *)data, len) != 0 && error == 0){
+        error = OTA_ERROR_STAGE;
+    }
+    return error;
+}
+
+/** complete
+ * @brief	Flushes the stage, if there is one, and finishes the image.
+ * @return  Return code
+ */
+int OTAPipeline::complete(){
+    if(running && stage && error == 0 && stage->finish(stage->context) != 0 && error == 0){
+        error = OTA_ERROR_STAGE;
+    }
+    return finish();
+}
+
+/** on_body
+ * @brief	HttpRequest body callback, see download().
+ * @param	Data
+ * @param	Length in bytes
+ */
+void OTAPipeline::on_body(const char *at, size_t length){
+    downloaded += length;
+    receive(at, length);
+}
+
+/** finish
+ * @brief	Writes the last partial buffer and waits for the flash.
+ * @return  Return code
+ */
+int OTAPipeline::finish(){
+    if(!running){
+        return OTA_ERROR_STATE;
+    }
+    if(filling){
+        if(buffers[fill].len > 0){
+            submit();
+        }
+        else{
+            filling = false;
+            freeBuffers.release();
+        }
+    }
+    stop();
+
+    if(error == 0){
+        error = image.commit();
+    }
+    else{
+        image.close();
+    }
+    return error;
+}
+
+/** abort
+ * @brief	Drops the buffered data and stops the writer.
+ */
+void OTAPipeline::abort(){
+    if(!running){
+        return;
+    }
+    if(error == 0){
+        error = OTA_ERROR_STATE;
+    }
+    if(filling){
+        buffers[fill].len = 0;
+        filling = false;
+        freeBuffers.release();
+    }
+    stop();
+    image.close();
+}
+
+/** is_whole
+ * @brief	Tells whether a download response carries the whole image.
+ * @param	Response, NULL if the request failed
+ * @return  True if the status is 200 and the body came in full
+ */
+bool OTAPipeline::is_whole(HttpResponse *response){
+    if(!response || response->get_status_code() != 200 || !response->is_message_complete()){
+        return false;
+    }
+    const char *length = response->get_header("Content-Length");
+    return !length || strtoul(length, NULL, 10) == downloaded;
+}
+
+/** download
+ * @brief	Downloads an image over HTTP or HTTPS straight into flash.
+ * @param	Network interface
+ * @param	URL
+ * @param	Trusted CAs for an https URL
+ * @param	Address of the image, see begin()
+ * @param	Maximum image size in bytes, see begin()
+ * @return  Return code
+ */
+int OTAPipeline::download(NetworkInterface *network, const char *url, const char *sslCaPem,
+                          uint32_t address, uint32_t maxSize){
+    int rc = begin(address, maxSize);
+    if(rc != 0){
+        return rc;
+    }
+
+    // a connection that closes early ends the body without an error, so
+    // the image is only finished once the whole response is in
+    bool whole = false;
+    if(strncmp(url, "https:", 6) == 0){
+        HttpsRequest *request = new HttpsRequest(network, sslCaPem, HTTP_GET, url,
+                                                 callback(this, &OTAPipeline::on_body));
+        whole = is_whole(request->send());
+        delete request;
+    }
+    else{
+        HttpRequest *request = new HttpRequest(network, HTTP_GET, url,
+                                               callback(this, &OTAPipeline::on_body));
+        whole = is_whole(request->send());
+        delete request;
+    }
+
+    if(!whole){
+        rc = error;
+        abort();
+        return rc ? rc : OTA_ERROR_DOWNLOAD;
+    }
+    return complete();
+}
+
+/** set_stage
+ * @brief	Routes the downloaded data through a stage, NULL for none.
+ * @param	Stage, must stay valid during download()
+ */
+void OTAPipeline::set_stage(const OTAStage *_stage){
+    stage = _stage;
+}
+
+/** written
+ * @brief	Returns the number of image bytes received so far.
+ * @return  Number of bytes
+ */
+uint32_t OTAPipeline::written(){
+    return received;
+}
+
+/** get_error
+ * @brief	Returns the first error, the rest of the image is dropped after it.
+ * @return  Return code
+ */
+int OTAPipeline::get_error(){
+    return error;
+}
+
+/** sink
+ * @brief	Feeds a pipeline, for a stage to write into.
+ * @param	Pipeline
+ * @param	Data
+ * @param	Length in bytes
+ * @return  Return code
+ */
+int OTAPipeline::sink(void *context, const uint8_t *data, size_t len){
+    return ((OTAPipeline *)context)->feed(data, len);
+}
+
+/** submit
+ * @brief	Hands the buffer being filled to the writer.
+ */
+void OTAPipeline::submit(){
+    filling = false;
+    fill = (fill + 1) % OTA_BUFFERS;
+    fullBuffers.release();
+}
+
+/** stop
+ * @brief	Lets the writer drain the queued buffers and exit.
+ */
+void OTAPipeline::stop(){
+    // an empty buffer tells the writer it has seen the last one
+    fullBuffers.release();
+    writer->join();
+    delete writer;
+    writer = NULL;
+
+    release_buffers();
+    running = false;
+}
+
+/** release_buffers
+ * @brief	Frees the buffers.
+ */
+void OTAPipeline::release_buffers(){
+    for(int i = 0; i < OTA_BUFFERS; i++){
+        free(buffers[i].data);
+        buffers[i].data = NULL;
+        buffers[i].len = 0;
+    }
+}
+
+/** writer_thread
+ * @brief	Programs the full buffers in order, and erases the next sector
+ *          before the network has filled the next buffer.
+ */
+void OTAPipeline::writer_thread(){
+    while(true){
+        fullBuffers.wait();
+
+        Buffer &b = buffers[drain];
+        if(b.len == 0){
+            break;
+        }
+
+        if(error == 0){
+            // only the last buffer can leave a partial page, commit() programs it
+            int rc = image.write(b.data, b.len);
+            if(rc == 0){
+                rc = image.erase_ahead(image.get_address() + bufferSize);
+            }
+            if(rc != 0){
+                error = rc;
+            }
+        }
+
+        b.len = 0;
+        drain = (drain + 1) % OTA_BUFFERS;
+        freeBuffers.release();
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ ******************************************************************************
+ * @file    OTAPipeline.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Firmware download written to flash while it is received.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _OTA_PIPELINE_H
+#define _OTA_PIPELINE_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "Flasher.h"
+#include "FlashWriter.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+#ifndef OTA_BUFFER_SIZE
+#define OTA_BUFFER_SIZE   1024  // bytes per buffer, rounded up to a multiple of the flash page size
+#endif
+
+#ifndef OTA_BUFFERS
+#define OTA_BUFFERS       2     // one is filled from the network while the other is programmed
+#endif
+
+#define OTA_ERROR_ERASE       FLASH_WRITER_ERROR_ERASE
+#define OTA_ERROR_PROGRAM     FLASH_WRITER_ERROR_PROGRAM
+#define OTA_ERROR_TOO_LARGE   FLASH_WRITER_ERROR_TOO_LARGE
+#define OTA_ERROR_STATE       FLASH_WRITER_ERROR_STATE
+#define OTA_ERROR_DOWNLOAD    5
+#define OTA_ERROR_NO_MEMORY   FLASH_WRITER_ERROR_NO_MEMORY
+#define OTA_ERROR_ALIGNMENT   FLASH_WRITER_ERROR_ALIGNMENT
+#define OTA_ERROR_STAGE       14
+
+/**
+ * Stage the downloaded data goes through before it is written, e.g. a
+ * decompressor or a DeltaPatch. feed() passes what it makes of the data to OTAPipeline::sink(),
+ * finish() is called once the download is complete. Both return 0 to
+ * continue.
+ */
+struct OTAStage {
+    int (*feed)(void *context, const uint8_t *data, size_t len);
+    int (*finish)(void *context);
+    void *context;
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+class HttpResponse;
+
+/**
+ * Writes a firmware image to flash while it is downloaded.
+ *
+ * feed() copies the received data into page aligned buffers. A writer thread
+ * programs the full ones, and erases the next sector as soon as the current
+ * one is being programmed, so the erase is done while the network delivers
+ * the next buffers rather than when they arrive. The download then takes
+ * about as long as the slower of the network and the flash, not their sum.
+ *
+ * On single bank parts the CPU stalls while the flash is busy. The overlap
+ * then comes from the modem buffering data meanwhile.
+ */
+class OTAPipeline{
+private:
+    struct Buffer {
+        uint8_t *data;
+        uint32_t len;
+    };
+
+    FlashWriter image;
+    Buffer buffers[OTA_BUFFERS];
+    uint32_t bufferSize;
+
+    uint32_t fill;              // buffer feed() copies into
+    uint32_t drain;             // next buffer the writer programs
+    Semaphore freeBuffers;
+    Semaphore fullBuffers;
+    Thread *writer;
+    const OTAStage *stage;
+
+    uint32_t received;
+    uint32_t downloaded;        // body bytes download() got, before the stage
+    volatile int error;
+    bool filling;               // feed() holds a buffer
+    bool running;
+
+    void writer_thread();
+    void submit();
+    void stop();
+    void release_buffers();
+    bool is_whole(HttpResponse *response);
+
+public:
+
+    OTAPipeline();
+    ~OTAPipeline();
+
+    int begin(uint32_t address = 0, uint32_t maxSize = 0);
+    int feed(const void *data, uint32_t len);
+    void on_body(const char *at, size_t length);
+    int finish();
+    void abort();
+    int receive(const void *data, uint32_t len);
+    int complete();
+    int download(NetworkInterface *network, const char *url, const char *sslCaPem = NULL,
+                 uint32_t address = 0, uint32_t maxSize = 0);
+    void set_stage(const OTAStage *stage);
+    uint32_t written();
+    int get_error();
+
+    static int sink(void *context, const uint8_t *data, size_t len);
+
+};
+
+#endif
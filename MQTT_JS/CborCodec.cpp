@@ -0,0 +1,491 @@
+/*
+ * @file    CborCodec.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   CBOR encoding of JavaScript values for MQTT payloads.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "CborCodec.h"
+
+#include <math.h>
+
+/* Constants -----------------------------------------------------------------*/
+
+#define CBOR_UINT        0
+#define CBOR_NEGINT      1
+#define CBOR_BYTES       2
+#define CBOR_TEXT        3
+#define CBOR_ARRAY       4
+#define CBOR_MAP         5
+#define CBOR_TAG         6
+#define CBOR_SIMPLE      7
+
+#define CBOR_FALSE       20
+#define CBOR_TRUE        21
+#define CBOR_NULL        22
+#define CBOR_UNDEFINED   23
+#define CBOR_FLOAT16     25
+#define CBOR_FLOAT32     26
+#define CBOR_FLOAT64     27
+
+#define CBOR_MAX_SAFE_INTEGER 9007199254740991.0 // 2^53 - 1
+
+static const unsigned char selfDescribeTag[CBOR_SELF_DESCRIBE_LEN] = { 0xD9, 0xD9, 0xF7 };
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	Constructor.
+ * @param	Buffer
+ * @param	Buffer length
+ */
+CborCodec::CborCodec(unsigned char *buf, size_t buflen){
+    ptr = buf;
+    end = buf + buflen;
+}
+
+/** writeHead
+ * @brief	Writes the initial byte and argument of a data item.
+ * @param	Major type
+ * @param	Argument
+ * @return  Return code
+ */
+int CborCodec::writeHead(uint8_t major, uint64_t value){
+    int extra;
+    uint8_t info;
+
+    if(value < 24){
+        info = (uint8_t)value;
+        extra = 0;
+    }
+    else if(value <= 0xFF){
+        info = 24;
+        extra = 1;
+    }
+    else if(value <= 0xFFFF){
+        info = 25;
+        extra = 2;
+    }
+    else if(value <= 0xFFFFFFFFULL){
+        info = 26;
+        extra = 4;
+    }
+    else{
+        info = 27;
+        extra = 8;
+    }
+
+    if(end - ptr < 1 + extra){
+        return CBOR_ERROR_BUFFER_TOO_SHORT;
+    }
+    *ptr++ = (major << 5) | info;
+    for(int i = extra - 1; i >= 0; i--){
+        *ptr++ = (uint8_t)(value >> (8 * i));
+    }
+    return 0;
+}
+
+/** writeBytes
+ * @brief	Writes raw bytes.
+ * @param	Data
+ * @param	Length
+ * @return  Return code
+ */
+int CborCodec::writeBytes(const void *data, size_t len){
+    if((size_t)(end - ptr) < len){
+        return CBOR_ERROR_BUFFER_TOO_SHORT;
+    }
+    memcpy(ptr, data, len);
+    ptr += len;
+    return 0;
+}
+
+/** writeNumber
+ * @brief	Writes a number as the shortest integer or float that holds it exactly.
+ * @param	Value
+ * @return  Return code
+ */
+int CborCodec::writeNumber(double value){
+    if(value == floor(value) && fabs(value) <= CBOR_MAX_SAFE_INTEGER){
+        if(value >= 0){
+            return writeHead(CBOR_UINT, (uint64_t)value);
+        }
+        return writeHead(CBOR_NEGINT, (uint64_t)(-1 - value));
+    }
+
+    float single = (float)value;
+    if((double)single == value || isnan(value)){
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        if(end - ptr < 5){
+            return CBOR_ERROR_BUFFER_TOO_SHORT;
+        }
+        *ptr++ = (CBOR_SIMPLE << 5) | CBOR_FLOAT32;
+        for(int i = 3; i >= 0; i--){
+            *ptr++ = (uint8_t)(bits >> (8 * i));
+        }
+        return 0;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if(end - ptr < 9){
+        return CBOR_ERROR_BUFFER_TOO_SHORT;
+    }
+    *ptr++ = (CBOR_SIMPLE << 5) | CBOR_FLOAT64;
+    for(int i = 7; i >= 0; i--){
+        *ptr++ = (uint8_t)(bits >> (8 * i));
+    }
+    return 0;
+}
+
+/** writeString
+ * @brief	Writes a JavaScript string as a CBOR text string, in UTF-8.
+ * @param	String value
+ * @return  Return code
+ */
+int CborCodec::writeString(jerry_value_t value){
+    jerry_size_t size = jerry_get_utf8_string_size(value);
+    int rc = writeHead(CBOR_TEXT, size);
+    if(rc != 0){
+        return rc;
+    }
+    if((size_t)(end - ptr) < size){
+        return CBOR_ERROR_BUFFER_TOO_SHORT;
+    }
+    ptr += jerry_string_to_utf8_char_buffer(value, (jerry_char_t*)ptr, size);
+    return 0;
+}
+
+/** writeValue
+ * @brief	Writes any JavaScript value, walking arrays and objects.
+ * @param	Value
+ * @param	Nesting depth
+ * @return  Return code
+ */
+int CborCodec::writeValue(jerry_value_t value, int depth){
+    uint8_t simple;
+    int rc = 0;
+
+    if(depth > CBOR_MAX_DEPTH){
+        return CBOR_ERROR_TOO_DEEP;
+    }
+
+    if(jerry_value_is_number(value)){
+        return writeNumber(jerry_get_number_value(value));
+    }
+    if(jerry_value_is_string(value)){
+        return writeString(value);
+    }
+    if(jerry_value_is_boolean(value)){
+        simple = (CBOR_SIMPLE << 5) | (jerry_get_boolean_value(value) ? CBOR_TRUE : CBOR_FALSE);
+        return writeBytes(&simple, 1);
+    }
+    if(jerry_value_is_null(value) || jerry_value_is_undefined(value) || jerry_value_is_function(value)){
+        simple = (CBOR_SIMPLE << 5) | (jerry_value_is_null(value) ? CBOR_NULL : CBOR_UNDEFINED);
+        return writeBytes(&simple, 1);
+    }
+    if(jerry_value_is_array(value)){
+        uint32_t length = jerry_get_array_length(value);
+        if((rc = writeHead(CBOR_ARRAY, length)) != 0){
+            return rc;
+        }
+        for(uint32_t i = 0; i < length && rc == 0; i++){
+            jerry_value_t item = jerry_get_property_by_index(value, i);
+            rc = writeValue(item, depth + 1);
+            jerry_release_value(item);
+        }
+        return rc;
+    }
+    if(jerry_value_is_object(value)){
+        jerry_value_t keys = jerry_get_object_keys(value);
+        uint32_t length = jerry_get_array_length(keys);
+        rc = writeHead(CBOR_MAP, length);
+        for(uint32_t i = 0; i < length && rc == 0; i++){
+            jerry_value_t key = jerry_get_property_by_index(keys, i);
+            jerry_value_t item = jerry_get_property(value, key);
+            rc = writeString(key);
+            if(rc == 0){
+                rc = writeValue(item, depth + 1);
+            }
+            jerry_release_value(item);
+            jerry_release_value(key);
+        }
+        jerry_release_value(keys);
+        return rc;
+    }
+    return CBOR_ERROR_UNSUPPORTED;
+}
+
+/** encode
+ * @brief	Encodes a JavaScript value to CBOR.
+ * @param	Value
+ * @param	Output buffer
+ * @param	Output buffer length
+ * @param	Whether to start with the self-describe tag, see isSelfDescribed()
+ * @return  Encoded length, negative on error
+ */
+int CborCodec::encode(jerry_value_t value, unsigned char *buf, size_t buflen, bool selfDescribe){
+    CborCodec codec(buf, buflen);
+    int rc = selfDescribe ? codec.writeBytes(selfDescribeTag, sizeof(selfDescribeTag)) : 0;
+    if(rc == 0){
+        rc = codec.writeValue(value, 0);
+    }
+    if(rc != 0){
+        return rc;
+    }
+    return codec.ptr - buf;
+}
+
+/** readHead
+ * @brief	Reads the initial byte and argument of a data item.
+ * @param	Major type
+ * @param	Additional information
+ * @param	Argument
+ * @return  True on success
+ */
+bool CborCodec::readHead(uint8_t *major, uint8_t *info, uint64_t *value){
+    int extra;
+
+    if(ptr >= end){
+        return false;
+    }
+    *major = *ptr >> 5;
+    *info = *ptr & 0x1F;
+    ptr++;
+
+    if(*info < 24){
+        *value = *info;
+        return true;
+    }
+    switch(*info){
+        case 24: extra = 1; break;
+        case 25: extra = 2; break;
+        case 26: extra = 4; break;
+        case 27: extra = 8; break;
+        default: return false; // indefinite lengths are not supported
+    }
+    if(end - ptr < extra){
+        return false;
+    }
+    *value = 0;
+    for(int i = 0; i < extra; i++){
+        *value = (*value << 8) | *ptr++;
+    }
+    return true;
+}
+
+/** readText
+ * @brief	Reads a text string as a JavaScript string.
+ * @param	Length
+ * @return  String value, or an error value
+ */
+jerry_value_t CborCodec::readText(uint64_t len){
+    if((uint64_t)(end - ptr) < len){
+        return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "Truncated CBOR string");
+    }
+    // the engine asserts on strings that are not well formed
+    if(!jerry_is_valid_utf8_string((const jerry_char_t *)ptr, (jerry_size_t)len)){
+        return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "Invalid UTF-8 in CBOR string");
+    }
+    jerry_value_t value = jerry_create_string_sz_from_utf8((const jerry_char_t *)ptr, (jerry_size_t)len);
+    ptr += len;
+    return value;
+}
+
+/** readBytes
+ * @brief	Reads a byte string as an array of numbers, since its bytes need
+ *          not be text.
+ * @param	Length
+ * @return  Array value, or an error value
+ */
+jerry_value_t CborCodec::readBytes(uint64_t len){
+    if((uint64_t)(end - ptr) < len){
+        return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "Truncated CBOR string");
+    }
+    jerry_value_t array = jerry_create_array((uint32_t)len);
+    for(uint32_t i = 0; i < len; i++){
+        jerry_value_t byte = jerry_create_number(*ptr++);
+        jerry_release_value(jerry_set_property_by_index(array, i, byte));
+        jerry_release_value(byte);
+    }
+    return array;
+}
+
+/** readValue
+ * @brief	Reads one data item as a JavaScript value.
+ * @param	Nesting depth
+ * @return  Value, or an error value
+ */
+jerry_value_t CborCodec::readValue(int depth){
+    uint8_t major, info;
+    uint64_t arg;
+
+    if(depth > CBOR_MAX_DEPTH){
+        return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "CBOR nesting too deep");
+    }
+    if(!readHead(&major, &info, &arg)){
+        return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "Malformed CBOR");
+    }
+
+    switch(major){
+        case CBOR_UINT:
+            return jerry_create_number((double)arg);
+        case CBOR_NEGINT:
+            return jerry_create_number(-1.0 - (double)arg);
+        case CBOR_BYTES:
+            return readBytes(arg);
+        case CBOR_TEXT:
+            return readText(arg);
+        case CBOR_ARRAY: {
+            if(arg > (uint64_t)(end - ptr)){
+                break; // every item takes at least one byte
+            }
+            jerry_value_t array = jerry_create_array((uint32_t)arg);
+            for(uint32_t i = 0; i < arg; i++){
+                jerry_value_t item = readValue(depth + 1);
+                if(jerry_value_has_error_flag(item)){
+                    jerry_release_value(array);
+                    return item;
+                }
+                jerry_release_value(jerry_set_property_by_index(array, i, item));
+                jerry_release_value(item);
+            }
+            return array;
+        }
+        case CBOR_MAP: {
+            if(arg > (uint64_t)(end - ptr) / 2){
+                break; // every pair takes at least two bytes
+            }
+            jerry_value_t object = jerry_create_object();
+            for(uint32_t i = 0; i < arg; i++){
+                jerry_value_t key = readValue(depth + 1);
+                if(jerry_value_has_error_flag(key)){
+                    jerry_release_value(object);
+                    return key;
+                }
+                if(!jerry_value_is_string(key) && !jerry_value_is_number(key)){
+                    jerry_release_value(key);
+                    jerry_release_value(object);
+                    return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "Unsupported CBOR map key");
+                }
+                if(!jerry_value_is_string(key)){
+                    // property names are strings, render integer keys as such
+                    char name[24];
+                    snprintf(name, sizeof(name), "%.0f", jerry_get_number_value(key));
+                    jerry_release_value(key);
+                    key = jerry_create_string((const jerry_char_t *)name);
+                }
+                jerry_value_t item = readValue(depth + 1);
+                if(jerry_value_has_error_flag(item)){
+                    jerry_release_value(key);
+                    jerry_release_value(object);
+                    return item;
+                }
+                jerry_release_value(jerry_set_property(object, key, item));
+                jerry_release_value(item);
+                jerry_release_value(key);
+            }
+            return object;
+        }
+        case CBOR_TAG:
+            return readValue(depth + 1); // tags are not interpreted, the tagged item is returned
+        case CBOR_SIMPLE:
+            switch(info){
+                case CBOR_FALSE:     return jerry_create_boolean(false);
+                case CBOR_TRUE:      return jerry_create_boolean(true);
+                case CBOR_NULL:      return jerry_create_null();
+                case CBOR_UNDEFINED: return jerry_create_undefined();
+                case CBOR_FLOAT16: {
+                    int exponent = (arg >> 10) & 0x1F;
+                    double mantissa = arg & 0x3FF;
+                    double value;
+                    if(exponent == 0){
+                        value = ldexp(mantissa, -24);
+                    }
+                    else if(exponent != 31){
+                        value = ldexp(mantissa + 1024, exponent - 25);
+                    }
+                    else{
+                        value = (mantissa == 0) ? INFINITY : NAN;
+                    }
+                    return jerry_create_number((arg & 0x8000) ? -value : value);
+                }
+                case CBOR_FLOAT32: {
+                    uint32_t bits = (uint32_t)arg;
+                    float value;
+                    memcpy(&value, &bits, sizeof(value));
+                    return jerry_create_number(value);
+                }
+                case CBOR_FLOAT64: {
+                    double value;
+                    memcpy(&value, &arg, sizeof(value));
+                    return jerry_create_number(value);
+                }
+                default:
+                    break;
+            }
+            break;
+    }
+    return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "Malformed or unsupported CBOR item");
+}
+
+/** decode
+ * @brief	Decodes a CBOR payload to a JavaScript value.
+ * @param	Payload
+ * @param	Payload length
+ * @return  Value, or an error value if the payload is not a single well-formed item
+ */
+jerry_value_t CborCodec::decode(const unsigned char *buf, size_t len){
+    CborCodec codec((unsigned char *)buf, len);
+    jerry_value_t value = codec.readValue(0);
+    if(!jerry_value_has_error_flag(value) && codec.ptr != codec.end){
+        jerry_release_value(value);
+        return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *) "Trailing bytes after CBOR item");
+    }
+    return value;
+}
+
+/** isSelfDescribed
+ * @brief	Tells whether a payload starts with the self-describe tag. Plain
+ *          text is often valid CBOR too ("5" decodes as -22), so only
+ *          payloads marked this way are taken for CBOR.
+ * @param	Payload
+ * @param	Payload length
+ * @return  True if the payload is marked as CBOR
+ */
+bool CborCodec::isSelfDescribed(const unsigned char *buf, size_t len){
+    return len > CBOR_SELF_DESCRIBE_LEN && memcmp(buf, selfDescribeTag, CBOR_SELF_DESCRIBE_LEN) == 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * @file    CborCodec.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   CBOR encoding of JavaScript values for MQTT payloads.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+
+#ifndef _CBOR_CODEC_H_
+#define _CBOR_CODEC_H_
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+
+#include "jerryscript-mbed-library-registry/wrap_tools.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+#define CBOR_MAX_DEPTH 8
+
+// Self-describe tag 55799 (RFC 7049 2.4.5), marks a payload as CBOR
+#define CBOR_SELF_DESCRIBE_LEN 3
+
+#define CBOR_ERROR_BUFFER_TOO_SHORT  -1
+#define CBOR_ERROR_UNSUPPORTED       -2
+#define CBOR_ERROR_TOO_DEEP          -3
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Encodes JavaScript values to CBOR (RFC 7049) straight from the engine, and
+ * decodes CBOR back to JavaScript values, so payloads do not have to go
+ * through JSON.stringify/JSON.parse in the interpreter.
+ */
+class CborCodec{
+private:
+    unsigned char *ptr;
+    unsigned char *end;
+
+    CborCodec(unsigned char *buf, size_t buflen);
+
+    int writeHead(uint8_t major, uint64_t value);
+    int writeBytes(const void *data, size_t len);
+    int writeNumber(double value);
+    int writeString(jerry_value_t value);
+    int writeValue(jerry_value_t value, int depth);
+
+    bool readHead(uint8_t *major, uint8_t *info, uint64_t *value);
+    jerry_value_t readText(uint64_t len);
+    jerry_value_t readBytes(uint64_t len);
+    jerry_value_t readValue(int depth);
+
+public:
+
+    /* Functions */
+
+    static int encode(jerry_value_t value, unsigned char *buf, size_t buflen, bool selfDescribe = false);
+
+    static jerry_value_t decode(const unsigned char *buf, size_t len);
+
+    static bool isSelfDescribed(const unsigned char *buf, size_t len);
+};
+
+#endif
@@ -28,6 +28,10 @@
 #include "MQTTPacket.h"
 #include <stdio.h>
 #include "MQTTLogging.h"
+#include "MQTTMetrics.h"
+#if defined(MQTT_TRACE)
+#include "MQTTTrace.h"
+#endif
 
 #if !defined(MQTTCLIENT_QOS1)
     #define MQTTCLIENT_QOS1 1
@@ -207,6 +211,17 @@ public:
      */
     int subscribe(const char* topicFilter, enum QoS qos, messageHandler mh, subackData &data);
 
+    /** MQTT Subscribe - send one MQTT subscribe packet carrying several topic filters and wait for the single suback
+     *  The topic filter strings are referenced by the message handlers, so they must outlive the subscriptions
+     *  @param count - the number of entries in topicFilters and qos, at most MAX_MESSAGE_HANDLERS
+     *  @param topicFilters - array of topic patterns which can include wildcards
+     *  @param qos - array of MQTT QoS to subscribe at, one per topic filter
+     *  @param mh - the callback function to be invoked when a message is received for any of these subscriptions
+     *  @param grantedQoS - optional array of count entries, returns the granted QoS of each filter (0x80 if refused)
+     *  @return success code - SUCCESS once the suback is received, even if the broker refused some of the filters
+     */
+    int subscribeMany(int count, const char* topicFilters[], enum QoS qos[], messageHandler mh, int grantedQoS[] = 0);
+
     /** MQTT Unsubscribe - send an MQTT unsubscribe packet and wait for the unsuback
      *  @param topicFilter - a topic pattern which can include wildcards
      *  @return success code -
@@ -234,6 +249,47 @@ public:
         return isconnected;
     }
 
+#if MQTTCLIENT_QOS1 || MQTTCLIENT_QOS2
+    /** Copy out the unacknowledged outbound publish, so it can be persisted across power cycles
+     *  Only tracked when connected with cleansession=0
+     *  @param buf - a buffer of at least MAX_MQTT_PACKET_SIZE bytes
+     *  @return the length of the serialized publish packet, 0 if nothing is in flight
+     */
+    int getInflightPacket(unsigned char* buf);
+
+    /** Restore a persisted outbound publish.  It is resent, flagged as duplicate, on the next connect
+     *  @param buf - the serialized publish packet returned by getInflightPacket
+     *  @param len - the length of the packet
+     *  @return success code -
+     */
+    int setInflightPacket(const unsigned char* buf, int len);
+#endif
+
+    /** Traffic counters and acknowledgement latencies since construction or the last reset
+     *  @return the metrics block, updated in place by the client
+     */
+    const Metrics& getMetrics() const
+    {
+        return metrics;
+    }
+
+    /** Zero all counters and histograms
+     */
+    void resetMetrics()
+    {
+        metrics.reset();
+    }
+
+#if defined(MQTT_TRACE)
+    /** The latest packets sent and received
+     *  @return the trace ring, dump() it to the console for tools/mqtt_trace_decode
+     */
+    Trace& getTrace()
+    {
+        return trace;
+    }
+#endif
+
 private:
 
     void closeSession();
@@ -248,6 +304,7 @@ private:
     int sendPacket(int length, Timer& timer);
     int deliverMessage(MQTTString& topicName, Message& message);
     bool isTopicMatched(char* topicFilter, MQTTString& topicName);
+    void recordLatency(LatencyHistogram& histogram, int start_ms, Timer& timer);
 
     Network& ipstack;
     unsigned long command_timeout_ms;
@@ -272,6 +329,11 @@ private:
 
     bool isconnected;
 
+    Metrics metrics;
+#if defined(MQTT_TRACE)
+    Trace trace;
+#endif
+
 #if MQTTCLIENT_QOS1 || MQTTCLIENT_QOS2
     unsigned char pubbuf[MAX_MQTT_PACKET_SIZE];  // store the last publish for sending on reconnect
     int inflightLen;
@@ -330,6 +392,15 @@ MQTT::Client<Network, Timer, a, MAX_MESSAGE_HANDLERS>::Client(Network& network,
     this->command_timeout_ms = command_timeout_ms;
     cleansession = true;
       closeSession();
+    metrics.reset();
+}
+
+
+template<class Network, class Timer, int a, int b>
+void MQTT::Client<Network, Timer, a, b>::recordLatency(LatencyHistogram& histogram, int start_ms, Timer& timer)
+{
+    int elapsed = start_ms - timer.left_ms();  // the command timer counts down from when the request was made
+    histogram.record(elapsed > 0 ? elapsed : 0);
 }
 
 
@@ -395,15 +466,15 @@ int MQTT::Client<Network, Timer, a, b>::sendPacket(int length, Timer& timer)
     {
         if (this->keepAliveInterval > 0)
             last_sent.countdown(this->keepAliveInterval); // record the fact that we have successfully sent the packet
+        metrics.packetsSent++;
+        metrics.bytesSent += length;
         rc = SUCCESS;
     }
     else
         rc = FAILURE;
 
-#if defined(MQTT_DEBUG)
-    char printbuf[150];
-    DEBUG("Rc %d from sending packet %s\r\n", rc, 
-        MQTTFormat_toServerString(printbuf, sizeof(printbuf), sendbuf, length));
+#if defined(MQTT_TRACE)
+    trace.record(true, sendbuf, length, rc);
 #endif
     return rc;
 }
@@ -464,6 +535,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::readPacket(Timer& tim
 
     if (rem_len > (MAX_MQTT_PACKET_SIZE - len))
     {
+        metrics.bufferOverflows++;
         rc = BUFFER_OVERFLOW;
         goto exit;
     }
@@ -476,15 +548,13 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::readPacket(Timer& tim
     rc = header.bits.type;
     if (this->keepAliveInterval > 0)
         last_received.countdown(this->keepAliveInterval); // record the fact that we have successfully received a packet
+    metrics.packetsReceived++;
+    metrics.bytesReceived += len + rem_len;
 exit:
 
-#if defined(MQTT_DEBUG)
-    if (rc >= 0)
-    {
-        char printbuf[50];
-        DEBUG("Rc %d receiving packet %s\r\n", rc, 
-            MQTTFormat_toClientString(printbuf, sizeof(printbuf), readbuf, len));
-    }
+#if defined(MQTT_TRACE)
+    if (len > 0) // something arrived, complete or not
+        trace.record(false, readbuf, (rc > 0) ? len + rem_len : len, rc);
 #endif
     return rc;
 }
@@ -606,6 +676,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::cycle(Timer& timer)
             if (MQTTDeserialize_publish((unsigned char*)&msg.dup, &intQoS, (unsigned char*)&msg.retained, (unsigned short*)&msg.id, &topicName,
                                  (unsigned char**)&msg.payload, (int*)&msg.payloadlen, readbuf, MAX_MQTT_PACKET_SIZE) != 1)
                 goto exit;
+            metrics.messagesReceived++;
             msg.qos = (enum QoS)intQoS;
 #if MQTTCLIENT_QOS2
             if (msg.qos != QOS2)
@@ -690,6 +761,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::keepalive()
         if (ping_sent.expired())
         {
             rc = FAILURE; // session failure
+            metrics.keepaliveFailures++;
             #if defined(MQTT_DEBUG)
                 DEBUG("PINGRESP not received in keepalive interval\r\n");
             #endif
@@ -734,6 +806,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::connect(MQTTPacket_co
     Timer connect_timer(command_timeout_ms);
     int rc = FAILURE;
     int len = 0;
+    int start_ms = connect_timer.left_ms();
 
     if (isconnected) // don't send connect packet again if we are already connected
         goto exit;
@@ -750,6 +823,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::connect(MQTTPacket_co
     // this will be a blocking call, wait for the connack
     if (waitfor(CONNACK, connect_timer) == CONNACK)
     {
+        recordLatency(metrics.connack, start_ms, connect_timer);
         data.rc = 0;
         data.sessionPresent = false;
         if (MQTTDeserialize_connack((unsigned char*)&data.sessionPresent,
@@ -785,7 +859,10 @@ exit:
     {
         isconnected = true;
         ping_outstanding = false;
+        metrics.connects++;
     }
+    else if (!isconnected)
+        metrics.connectFailures++;
     return rc;
 }
 
@@ -856,6 +933,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, MAX_MESSAGE_HANDLERS>::su
     int rc = FAILURE;
     Timer timer(command_timeout_ms);
     int len = 0;
+    int start_ms = timer.left_ms();
     MQTTString topic = {(char*)topicFilter, {0, 0}};
 
     if (!isconnected)
@@ -869,6 +947,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, MAX_MESSAGE_HANDLERS>::su
 
     if (waitfor(SUBACK, timer) == SUBACK)      // wait for suback
     {
+        recordLatency(metrics.suback, start_ms, timer);
         int count = 0;
         unsigned short mypacketid;
         data.grantedQoS = 0;
@@ -896,6 +975,67 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, MAX_MESSAGE_HANDLERS>::su
 }
 
 
+template<class Network, class Timer, int MAX_MQTT_PACKET_SIZE, int MAX_MESSAGE_HANDLERS>
+int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, MAX_MESSAGE_HANDLERS>::subscribeMany(int count, const char* topicFilters[],
+     enum QoS qos[], messageHandler messageHandler, int grantedQoS[])
+{
+    int rc = FAILURE;
+    Timer timer(command_timeout_ms);
+    int len = 0;
+    int start_ms = timer.left_ms();
+    MQTTString topics[MAX_MESSAGE_HANDLERS];
+    int requestedQoS[MAX_MESSAGE_HANDLERS];     // enums and ints can be different size
+    int granted[MAX_MESSAGE_HANDLERS + 1];      // MQTTDeserialize_suback can store one entry past maxcount
+
+    if (count <= 0 || count > MAX_MESSAGE_HANDLERS)
+        return FAILURE;
+
+    if (!isconnected)
+        goto exit;
+
+    for (int i = 0; i < count; ++i)
+    {
+        topics[i].cstring = (char*)topicFilters[i];
+        topics[i].lenstring.len = 0;
+        topics[i].lenstring.data = 0;
+        requestedQoS[i] = qos[i];
+    }
+
+    len = MQTTSerialize_subscribe(sendbuf, MAX_MQTT_PACKET_SIZE, 0, packetid.getNext(), count, topics, requestedQoS);
+    if (len <= 0)
+        goto exit;
+    if ((rc = sendPacket(len, timer)) != SUCCESS) // send the subscribe packet
+        goto exit;             // there was a problem
+
+    if (waitfor(SUBACK, timer) == SUBACK)      // wait for the one suback covering all the filters
+    {
+        recordLatency(metrics.suback, start_ms, timer);
+        int received = 0;
+        unsigned short mypacketid;
+        if (MQTTDeserialize_suback(&mypacketid, count, &received, granted, readbuf, MAX_MQTT_PACKET_SIZE) == 1 &&
+                received == count)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                if (grantedQoS)
+                    grantedQoS[i] = granted[i];
+                if (granted[i] != 0x80)
+                    setMessageHandler(topicFilters[i], messageHandler);
+            }
+        }
+        else
+            rc = FAILURE;
+    }
+    else
+        rc = FAILURE;
+
+exit:
+    if (rc == FAILURE)
+        closeSession();
+    return rc;
+}
+
+
 template<class Network, class Timer, int MAX_MQTT_PACKET_SIZE, int MAX_MESSAGE_HANDLERS>
 int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, MAX_MESSAGE_HANDLERS>::unsubscribe(const char* topicFilter)
 {
@@ -935,6 +1075,7 @@ template<class Network, class Timer, int MAX_MQTT_PACKET_SIZE, int b>
 int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::publish(int len, Timer& timer, enum QoS qos)
 {
     int rc;
+    int start_ms = timer.left_ms();
 
     if ((rc = sendPacket(len, timer)) != SUCCESS) // send the publish packet
         goto exit; // there was a problem
@@ -944,6 +1085,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::publish(int len, Time
     {
         if (waitfor(PUBACK, timer) == PUBACK)
         {
+            recordLatency(metrics.puback, start_ms, timer);
             unsigned short mypacketid;
             unsigned char dup, type;
             if (MQTTDeserialize_ack(&type, &dup, &mypacketid, readbuf, MAX_MQTT_PACKET_SIZE) != 1)
@@ -960,6 +1102,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::publish(int len, Time
     {
         if (waitfor(PUBCOMP, timer) == PUBCOMP)
         {
+            recordLatency(metrics.puback, start_ms, timer);
             unsigned short mypacketid;
             unsigned char dup, type;
             if (MQTTDeserialize_ack(&type, &dup, &mypacketid, readbuf, MAX_MQTT_PACKET_SIZE) != 1)
@@ -988,6 +1131,7 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::publish(const char* t
     MQTTString topicString = MQTTString_initializer;
     int len = 0;
 
+    metrics.publishes++;
     if (!isconnected)
         goto exit;
 
@@ -1001,7 +1145,10 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::publish(const char* t
     len = MQTTSerialize_publish(sendbuf, MAX_MQTT_PACKET_SIZE, 0, qos, retained, id,
               topicString, (unsigned char*)payload, payloadlen);
     if (len <= 0)
+    {
+        rc = BUFFER_OVERFLOW; // will never fit, retrying cannot help
         goto exit;
+    }
 
 #if MQTTCLIENT_QOS1 || MQTTCLIENT_QOS2
     if (!cleansession)
@@ -1018,6 +1165,8 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::publish(const char* t
 
     rc = publish(len, timer, qos);
 exit:
+    if (rc != SUCCESS)
+        metrics.publishFailures++;
     return rc;
 }
 
@@ -1037,6 +1186,54 @@ int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::publish(const char* t
 }
 
 
+#if MQTTCLIENT_QOS1 || MQTTCLIENT_QOS2
+template<class Network, class Timer, int MAX_MQTT_PACKET_SIZE, int b>
+int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::getInflightPacket(unsigned char* buf)
+{
+    if (inflightMsgid == 0)
+        return 0;
+#if MQTTCLIENT_QOS2
+    if (pubrel)
+        return 0;   // only the PUBREL is left to send, which connect regenerates from the id
+#endif
+    memcpy(buf, pubbuf, inflightLen);
+    return inflightLen;
+}
+
+
+template<class Network, class Timer, int MAX_MQTT_PACKET_SIZE, int b>
+int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::setInflightPacket(const unsigned char* buf, int len)
+{
+    int rc = FAILURE;
+    unsigned char dup, retained;
+    unsigned short id;
+    int qos;
+    MQTTString topicName = MQTTString_initializer;
+    unsigned char* payload;
+    int payloadlen;
+
+    if (len <= 0 || len > MAX_MQTT_PACKET_SIZE)
+        goto exit;
+
+    memcpy(pubbuf, buf, len);
+    if (MQTTDeserialize_publish(&dup, &qos, &retained, &id, &topicName, &payload, &payloadlen, pubbuf, len) != 1 ||
+            qos == QOS0)
+        goto exit;
+
+    pubbuf[0] |= 0x08;  // set the DUP flag, the broker may already have seen this packet
+    inflightMsgid = id;
+    inflightLen = len;
+    inflightQoS = (enum QoS)qos;
+#if MQTTCLIENT_QOS2
+    pubrel = false;
+#endif
+    rc = SUCCESS;
+exit:
+    return rc;
+}
+#endif
+
+
 template<class Network, class Timer, int MAX_MQTT_PACKET_SIZE, int b>
 int MQTT::Client<Network, Timer, MAX_MQTT_PACKET_SIZE, b>::disconnect()
 {
@@ -2,6 +2,22 @@
 #define MQTT_LOGGING_H
 
 #define STREAM      stdout
+
+#if defined(DEFERRED_LOG)
+/* queued for the DeferredLog thread; __FUNCTION__ rather than __PRETTY_FUNCTION__ so the
+   name fits the record, and the format must be a literal */
+#include "DeferredLog.h"
+#if !defined(DEBUG)
+#define DEBUG(fmt, ...)  DLOG("DEBUG:   %s L#%d " fmt, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#endif
+#if !defined(LOG)
+#define LOG(fmt, ...)    DLOG("LOG:   %s L#%d " fmt, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#endif
+#if !defined(WARN)
+#define WARN(fmt, ...)   DLOG("WARN:  %s L#%d " fmt, __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#endif
+#endif
+
 #if !defined(DEBUG)
 #define DEBUG(...)    \
     {\
@@ -0,0 +1,129 @@
+/*
+ * @file    MQTTMetrics.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Counters and latency histograms of the MQTT client.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+#if !defined(MQTTMETRICS_H)
+#define MQTTMETRICS_H
+
+#include <stdint.h>
+#include <string.h>
+
+namespace MQTT
+{
+
+#define MQTT_LATENCY_BUCKETS 10
+
+/**
+ * Upper bounds in ms of the latency buckets, the last bucket takes everything slower.
+ */
+static const uint32_t latencyBucketBounds[MQTT_LATENCY_BUCKETS - 1] = { 10, 20, 50, 100, 200, 500, 1000, 2000, 5000 };
+
+/**
+ * Fixed-bucket histogram of a request/acknowledgement round trip.
+ */
+struct LatencyHistogram
+{
+    uint32_t buckets[MQTT_LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t total_ms;
+    uint32_t max_ms;
+
+    void record(uint32_t ms)
+    {
+        int i = 0;
+        while (i < MQTT_LATENCY_BUCKETS - 1 && ms > latencyBucketBounds[i])
+            ++i;
+        buckets[i]++;
+        count++;
+        total_ms += ms;
+        if (ms > max_ms)
+            max_ms = ms;
+    }
+
+    uint32_t average_ms() const
+    {
+        return count ? total_ms / count : 0;
+    }
+};
+
+/**
+ * Client metrics.  Only the thread driving the client writes them, and every field is a
+ * single aligned word, so readers need no lock: copy the block and read the copy.
+ */
+struct Metrics
+{
+    uint32_t bytesSent;
+    uint32_t bytesReceived;
+    uint32_t packetsSent;
+    uint32_t packetsReceived;
+    uint32_t publishes;           // publishes handed to the client
+    uint32_t publishFailures;     // publishes not sent or not acknowledged
+    uint32_t messagesReceived;
+    uint32_t connects;
+    uint32_t connectFailures;
+    uint32_t keepaliveFailures;   // PINGRESP not received in time
+    uint32_t bufferOverflows;     // incoming packets larger than the read buffer
+
+    LatencyHistogram connack;
+    LatencyHistogram puback;      // PUBACK for QoS 1, PUBCOMP for QoS 2
+    LatencyHistogram suback;
+
+    void reset()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+};
+
+/**
+ * TLS transport metrics, full handshakes against resumed sessions.
+ */
+struct TLSMetrics
+{
+    uint32_t fullHandshakes;
+    uint32_t resumedHandshakes;
+    uint32_t handshakeFailures;
+
+    LatencyHistogram full;
+    LatencyHistogram resumed;
+
+    void reset()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+};
+
+}
+
+#endif
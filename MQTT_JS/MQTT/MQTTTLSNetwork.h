@@ -0,0 +1,151 @@
+#ifndef _MQTTTLSNETWORK_H_
+#define _MQTTTLSNETWORK_H_
+ 
+#include "NetworkInterface.h"
+#include "tls_socket.h"
+#include "MQTTMetrics.h"
+ 
+/**
+ * TLS transport for MQTT::Client, on top of the mbed-http TLSSocket.
+ * The negotiated session is kept across reconnects and offered again, so a
+ * reconnect normally skips the certificate exchange and the key agreement.
+ */
+class MQTTTLSNetwork {
+public:
+    MQTTTLSNetwork(NetworkInterface* aNetwork) : network(aNetwork), tls(NULL), ca_pem(NULL), ca_hash(0), haveSession(false) {
+        mbedtls_ssl_session_init(&session);
+        metrics.reset();
+    }
+ 
+    ~MQTTTLSNetwork() {
+        disconnect();
+        mbedtls_ssl_session_free(&session);
+    }
+
+    /* the PEM must stay valid while the network is in use */
+    void setCA(const char* pem) {
+        // a resumed session skips the certificate check, so it is only
+        // offered to the same trust anchors that verified it
+        uint32_t hash = hashCA(pem);
+        if (hash != ca_hash)
+            clearSession();
+        ca_pem = pem;
+        ca_hash = hash;
+    }
+
+    /* forget the cached session, the next connect does a full handshake */
+    void clearSession() {
+        mbedtls_ssl_session_free(&session);
+        mbedtls_ssl_session_init(&session);
+        haveSession = false;
+    }
+
+    const MQTT::TLSMetrics& getMetrics() const {
+        return metrics;
+    }
+ 
+    int read(unsigned char* buffer, int len, int timeout) {
+        if (tls == NULL)
+            return NSAPI_ERROR_NO_SOCKET;
+        // a packet can span TLS records, keep reading until it is complete or the time is up
+        Timer timer;
+        timer.start();
+        int got = 0;
+        while (got < len) {
+            int left = timeout - timer.read_ms();
+            tls->get_tcp_socket()->set_timeout(left > 0 ? left : 0);
+            int rc = mbedtls_ssl_read(tls->get_ssl_context(), buffer + got, len - got);
+            if (rc == MBEDTLS_ERR_SSL_WANT_READ || rc == MBEDTLS_ERR_SSL_WANT_WRITE) {
+                if (left <= 0)
+                    break;
+                continue;
+            }
+            if (rc <= 0)  // closed by the broker or broken, hand over what arrived first
+                return got > 0 ? got : NSAPI_ERROR_NO_CONNECTION;
+            got += rc;
+        }
+        return got > 0 ? got : NSAPI_ERROR_WOULD_BLOCK;
+    }
+ 
+    int write(unsigned char* buffer, int len, int timeout) {
+        if (tls == NULL)
+            return NSAPI_ERROR_NO_SOCKET;
+        // bounded like read(), a send timeout shows up as WANT_WRITE
+        Timer timer;
+        timer.start();
+        int sent = 0;
+        while (sent < len) {
+            int left = timeout - timer.read_ms();
+            tls->get_tcp_socket()->set_timeout(left > 0 ? left : 0);
+            int rc = mbedtls_ssl_write(tls->get_ssl_context(), buffer + sent, len - sent);
+            if (rc == MBEDTLS_ERR_SSL_WANT_READ || rc == MBEDTLS_ERR_SSL_WANT_WRITE) {
+                if (left <= 0)
+                    break;
+                continue;
+            }
+            if (rc < 0)
+                return sent > 0 ? sent : rc;
+            sent += rc;
+        }
+        return sent > 0 ? sent : NSAPI_ERROR_WOULD_BLOCK;
+    }
+ 
+    int connect(const char* hostname, int port) {
+        if (ca_pem == NULL)
+            return NSAPI_ERROR_PARAMETER;
+        disconnect();
+
+        tls = new TLSSocket(network, hostname, port, ca_pem);
+        if (haveSession)
+            tls->set_session(&session);
+        int rc = tls->connect();
+        if (rc != 0) {
+            metrics.handshakeFailures++;
+            delete tls;
+            tls = NULL;
+            return rc;
+        }
+
+        if (tls->session_resumed()) {
+            metrics.resumedHandshakes++;
+            metrics.resumed.record(tls->handshake_ms());
+        }
+        else {
+            metrics.fullHandshakes++;
+            metrics.full.record(tls->handshake_ms());
+        }
+
+        // keep the session, or the fresh one the broker issued, for the next reconnect
+        clearSession();
+        haveSession = (tls->get_session(&session) == 0);
+        return 0;
+    }
+ 
+    int disconnect() {
+        if (tls) {
+            mbedtls_ssl_close_notify(tls->get_ssl_context());
+            delete tls;  // closes the socket
+            tls = NULL;
+        }
+        return 0;
+    }
+		 
+private:
+    /* FNV-1a, the PEM pointer alone can be reused for other contents */
+    static uint32_t hashCA(const char* pem) {
+        uint32_t h = 2166136261UL;
+        for (; pem && *pem; pem++)
+            h = (h ^ (unsigned char)*pem) * 16777619UL;
+        return h;
+    }
+
+    NetworkInterface* network;
+    TLSSocket* tls;
+    const char* ca_pem;
+    uint32_t ca_hash;
+    mbedtls_ssl_session session;
+    bool haveSession;
+    MQTT::TLSMetrics metrics;
+};
+ 
+#endif // _MQTTTLSNETWORK_H_
@@ -0,0 +1,143 @@
+/*
+ * @file    MQTTTrace.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Binary trace ring of MQTT packet events.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+#if !defined(MQTTTRACE_H)
+#define MQTTTRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(MQTT_TRACE_DEPTH)
+    #define MQTT_TRACE_DEPTH 64     // records, a power of two
+#endif
+#define MQTT_TRACE_HEAD 6           // leading packet bytes kept, enough for every ack
+
+#if !defined(MQTT_TRACE_CLOCK)
+    #include "us_ticker_api.h"
+    #define MQTT_TRACE_CLOCK() us_ticker_read()
+#endif
+
+namespace MQTT
+{
+
+/**
+ * One packet event.  Small control packets fit in head entirely, so the host decoder can
+ * render them with MQTTFormat; longer ones are described from the header byte and the id.
+ */
+struct TraceRecord
+{
+    uint32_t time_us;
+    uint16_t len;                           // whole packet, fixed header included
+    uint16_t id;                            // packet identifier, 0 if the packet has none
+    int8_t rc;
+    uint8_t sent;                           // 1 for packets sent, 0 for packets received
+    unsigned char head[MQTT_TRACE_HEAD];
+};
+
+/**
+ * Fixed ring of the latest packet events.  Recording copies 16 bytes and does no formatting,
+ * so tracing can stay on without changing timing; dump() prints the ring as hex for
+ * tools/mqtt_trace_decode.
+ */
+class Trace
+{
+public:
+
+    Trace() : next(0)
+    {
+        memset(records, 0, sizeof(records));
+    }
+
+    void record(bool sent, const unsigned char* buf, int len, int rc)
+    {
+        TraceRecord& r = records[next++ & (MQTT_TRACE_DEPTH - 1)];
+        r.time_us = MQTT_TRACE_CLOCK();
+        r.len = (uint16_t)len;
+        r.id = packetId(buf, len);
+        r.rc = (int8_t)rc;
+        r.sent = sent;
+        memcpy(r.head, buf, len < MQTT_TRACE_HEAD ? len : MQTT_TRACE_HEAD);
+    }
+
+    void dump(FILE* stream)
+    {
+        uint32_t last = next;
+        uint32_t first = last > MQTT_TRACE_DEPTH ? last - MQTT_TRACE_DEPTH : 0;
+        for (uint32_t i = first; i < last; ++i)
+        {
+            const unsigned char* p = (const unsigned char*)&records[i & (MQTT_TRACE_DEPTH - 1)];
+            fprintf(stream, "MQTTTRACE ");
+            for (unsigned int j = 0; j < sizeof(TraceRecord); ++j)
+                fprintf(stream, "%02x", p[j]);
+            fprintf(stream, "\r\n");
+        }
+    }
+
+    uint32_t count() const
+    {
+        return next;
+    }
+
+private:
+
+    static uint16_t packetId(const unsigned char* buf, int len)
+    {
+        int type = buf[0] >> 4;
+        int pos = 1;
+        while (pos < len && pos < 5 && (buf[pos] & 0x80))   // skip the remaining length
+            ++pos;
+        ++pos;
+        if (type == 3)                                       // PUBLISH, id after the topic when QoS > 0
+        {
+            if (((buf[0] >> 1) & 0x03) == 0 || pos + 2 > len)
+                return 0;
+            pos += 2 + ((buf[pos] << 8) | buf[pos + 1]);
+        }
+        else if (type < 4 || type > 11)                      // only PUBACK to UNSUBACK carry an id
+            return 0;
+        if (pos + 2 > len)
+            return 0;
+        return (buf[pos] << 8) | buf[pos + 1];
+    }
+
+    TraceRecord records[MQTT_TRACE_DEPTH];
+    uint32_t next;
+};
+
+}
+
+#endif
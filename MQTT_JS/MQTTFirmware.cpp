@@ -0,0 +1,327 @@
+/*
+ * @file    MQTTFirmware.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Firmware transfer over the MQTT connection.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "MQTTFirmware.h"
+
+/** getLE32
+ * @brief	Reads a little endian 32 bit number.
+ * @param	Bytes
+ * @return  Number
+ */
+static uint32_t getLE32(const uint8_t *p){
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** putLE32
+ * @brief	Writes a little endian 32 bit number.
+ * @param	Bytes
+ * @param	Number
+ */
+static void putLE32(uint8_t *p, uint32_t value){
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+/** Constructor
+ * @brief	Constructor.
+ * @param	Function publishing the acks
+ */
+MQTTFirmware::MQTTFirmware(publishSenderType _sender){
+    sender = _sender;
+    update = NULL;
+    topic[0] = '\0';
+    ackTopic[0] = '\0';
+    state = TRANSFER_IDLE;
+    transferId = 0;
+    length = 0;
+    offset = 0;
+    acked = 0;
+    stalled = false;
+    result = 0;
+    expecting = false;
+}
+
+/** Destructor
+ * @brief	Destructor.
+ */
+MQTTFirmware::~MQTTFirmware(){
+    delete update;
+}
+
+/** setTopic
+ * @brief	Sets the topic the updates arrive on, the acks go to the topic
+ *          followed by "/ack".
+ * @param	Topic
+ * @return  Return code
+ */
+int MQTTFirmware::setTopic(const char *_topic){
+    if(!_topic || _topic[0] == '\0' ||
+        strlen(_topic) + strlen(FIRMWARE_MQTT_ACK_SUFFIX) >= FIRMWARE_MQTT_TOPIC_LEN){
+        return 1; // invalid topic
+    }
+    strcpy(topic, _topic);
+    strcpy(ackTopic, _topic);
+    strcat(ackTopic, FIRMWARE_MQTT_ACK_SUFFIX);
+    return 0;
+}
+
+/** expect
+ * @brief	Sets the SHA-256 of the image the next offer has to be for. It
+ *          comes from the application, the offer itself is not trusted.
+ * @param	SHA-256 of the image
+ */
+void MQTTFirmware::expect(const uint8_t _sha256[32]){
+    memcpy(expected, _sha256, sizeof(expected));
+    expecting = true;
+}
+
+/** getTopic
+ * @brief	Returns the topic the updates arrive on.
+ * @return  Topic, empty if none is set
+ */
+const char *MQTTFirmware::getTopic(){
+    return topic;
+}
+
+/** receive
+ * @brief	Handles a message from the update topic.
+ * @param	Payload
+ * @param	Payload length
+ */
+void MQTTFirmware::receive(const void *payload, size_t payloadlen){
+    const uint8_t *msg = (const uint8_t *)payload;
+
+    if(payloadlen == 0){
+        return;
+    }
+    if(msg[0] == FIRMWARE_MSG_OFFER){
+        offer(msg, payloadlen);
+    }
+    else if(msg[0] == FIRMWARE_MSG_CHUNK){
+        chunk(msg, payloadlen);
+    }
+}
+
+/** resume
+ * @brief	Tells the sender where the transfer stands, after a reconnect.
+ * @return  Return code
+ */
+int MQTTFirmware::resume(){
+    if(state != TRANSFER_RECEIVING){
+        return 0;
+    }
+    stalled = false;
+    return ack();
+}
+
+/** getState
+ * @brief	Returns the state of the last transfer.
+ * @return  FirmwareTransferState
+ */
+int MQTTFirmware::getState(){
+    return state;
+}
+
+/** getOffset
+ * @brief	Returns the number of bytes received in order.
+ * @return  Number of bytes
+ */
+uint32_t MQTTFirmware::getOffset(){
+    return offset;
+}
+
+/** getLength
+ * @brief	Returns the length of the transfer.
+ * @return  Number of bytes
+ */
+uint32_t MQTTFirmware::getLength(){
+    return length;
+}
+
+/** getResult
+ * @brief	Returns the return code of the last transfer.
+ * @return  Return code
+ */
+int MQTTFirmware::getResult(){
+    return result;
+}
+
+/** offer
+ * @brief	Starts a transfer, or acks again if it is the current one.
+ * @param	Message
+ * @param	Message length
+ */
+void MQTTFirmware::offer(const uint8_t *msg, size_t len){
+    if(len != FIRMWARE_OFFER_LEN){
+        return;
+    }
+    uint8_t flags = msg[1];
+    uint32_t id = getLE32(msg + 2);
+
+    if(state != TRANSFER_IDLE && id == transferId){
+        // The sender lost track, e.g. after a reconnect
+        stalled = false;
+        ack();
+        return;
+    }
+
+    if(!expecting || memcmp(msg + 10, expected, sizeof(expected)) != 0){
+        // Not the image the application asked for, a running transfer goes on
+        sendAck(TRANSFER_FAILED, id, FIRMWARE_ERROR_VERIFY);
+        return;
+    }
+
+    if(update){
+        update->abort(); // a newer transfer replaces this one
+    }
+    else{
+        update = new FirmwareUpdate();
+    }
+
+    transferId = id;
+    length = getLE32(msg + 6);
+    memcpy(sha256, expected, sizeof(sha256));
+    offset = 0;
+    acked = 0;
+    stalled = false;
+    result = 0;
+
+    int rc = length ? update->begin(flags & FIRMWARE_FLAG_PATCH, flags & FIRMWARE_FLAG_COMPRESSED)
+                    : FIRMWARE_ERROR_NO_IMAGE;
+    if(rc != 0){
+        end(rc);
+        return;
+    }
+    state = TRANSFER_RECEIVING;
+    ack();
+}
+
+/** chunk
+ * @brief	Writes the next chunk, or acks the offset expected instead.
+ * @param	Message
+ * @param	Message length
+ */
+void MQTTFirmware::chunk(const uint8_t *msg, size_t len){
+    if(len < FIRMWARE_CHUNK_HEADER_LEN || state == TRANSFER_IDLE || getLE32(msg + 1) != transferId){
+        return; // not for this transfer
+    }
+    uint32_t at = getLE32(msg + 5);
+    const uint8_t *data = msg + FIRMWARE_CHUNK_HEADER_LEN;
+    uint32_t n = len - FIRMWARE_CHUNK_HEADER_LEN;
+
+    if(state != TRANSFER_RECEIVING || at != offset){
+        // Answer once, the sender goes back to the acked offset
+        if(!stalled){
+            stalled = true;
+            ack();
+        }
+        return;
+    }
+    if(n > length - offset){
+        end(FIRMWARE_ERROR_TOO_LARGE);
+        return;
+    }
+
+    int rc = update->feed(data, n);
+    if(rc != 0){
+        end(rc);
+        return;
+    }
+    offset += n;
+    stalled = false;
+
+    if(offset == length){
+        end(update->finish(sha256));
+    }
+    else if(offset - acked >= FIRMWARE_MQTT_WINDOW / 2){
+        ack();
+    }
+}
+
+/** end
+ * @brief	Ends the transfer and reports how it went.
+ * @param	Return code
+ */
+void MQTTFirmware::end(int rc){
+    delete update; // drops what is left of a failed update
+    update = NULL;
+    result = rc;
+    state = rc == 0 ? TRANSFER_INSTALLED : TRANSFER_FAILED;
+    if(rc == 0){
+        expecting = false; // installing it again takes another expect()
+    }
+    ack();
+}
+
+/** ack
+ * @brief	Publishes the state of the transfer.
+ * @return  Return code
+ */
+int MQTTFirmware::ack(){
+    acked = offset;
+    return sendAck(state, transferId, result);
+}
+
+/** sendAck
+ * @brief	Publishes an ack, also for an offer that is refused.
+ * @param	State
+ * @param	Transfer id
+ * @param	Result
+ * @return  Return code
+ */
+int MQTTFirmware::sendAck(uint8_t ackState, uint32_t id, int rc){
+    bool current = id == transferId;
+    uint8_t msg[FIRMWARE_ACK_LEN];
+    msg[0] = FIRMWARE_MSG_ACK;
+    msg[1] = ackState;
+    putLE32(msg + 2, id);
+    putLE32(msg + 6, current ? offset : 0);
+    putLE32(msg + 10, ackState == TRANSFER_RECEIVING ? FIRMWARE_MQTT_WINDOW : 0);
+    putLE32(msg + 14, (uint32_t)rc);
+
+    MQTT::Message message;
+    message.qos = MQTT::QOS0; // the next ack supersedes a lost one
+    message.retained = false;
+    message.dup = false;
+    message.payload = msg;
+    message.payloadlen = sizeof(msg);
+    return sender(ackTopic, message);
+}
@@ -0,0 +1,151 @@
+/*
+ * @file    MQTTFirmware.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Firmware transfer over the MQTT connection.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+
+#ifndef _MQTT_FIRMWARE_H_
+#define _MQTT_FIRMWARE_H_
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "MQTTClient.h"
+#include "MQTTPublishQueue.h"
+#include "FirmwareSlots.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+/* Bytes the sender may send past the last acknowledged offset */
+#ifndef FIRMWARE_MQTT_WINDOW
+#define FIRMWARE_MQTT_WINDOW      4096
+#endif
+
+#define FIRMWARE_MQTT_TOPIC_LEN   32
+#define FIRMWARE_MQTT_ACK_SUFFIX  "/ack"
+
+#define FIRMWARE_MSG_OFFER        'O'
+#define FIRMWARE_MSG_CHUNK        'C'
+#define FIRMWARE_MSG_ACK          'A'
+
+#define FIRMWARE_OFFER_LEN        42    // type, flags, transfer id, length, SHA-256
+#define FIRMWARE_CHUNK_HEADER_LEN 9     // type, transfer id, offset
+#define FIRMWARE_ACK_LEN          18    // type, state, transfer id, offset, window, result
+
+#define FIRMWARE_FLAG_COMPRESSED  0x01  // packed with tools/lzss_pack.cpp
+#define FIRMWARE_FLAG_PATCH       0x02  // made with tools/delta_patch.cpp
+
+enum FirmwareTransferState { TRANSFER_IDLE = 0, TRANSFER_RECEIVING, TRANSFER_INSTALLED, TRANSFER_FAILED };
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Receives a firmware update on an MQTT topic and writes it to the inactive
+ * slot as it arrives, see FirmwareUpdate.
+ *
+ * All numbers are little endian. The sender publishes on the topic:
+ *   offer  'O', flags, transfer id, length, SHA-256 of the image
+ *   chunk  'C', transfer id, offset, data
+ * and the receiver answers on the topic followed by "/ack":
+ *   ack    'A', state, transfer id, offset, window, result
+ *
+ * Anyone who can publish on the topic can send an offer, so the SHA-256 in
+ * it is not trusted. The application passes the SHA-256 of the image it
+ * wants to expect(), having learned it from a source it trusts. Any other
+ * offer fails with FIRMWARE_ERROR_VERIFY and leaves a running transfer
+ * alone. The install uses up the expected hash.
+ *
+ * Chunks are taken in order only. The ack carries the offset of the next
+ * byte expected, and the sender may have up to window bytes past it on
+ * the way; it is sent after every half window, once for a chunk out of
+ * order, and at the end. A sender that hears nothing for a while sends
+ * again from the last acknowledged offset. After a reconnect the receiver
+ * acks again with the offset it reached, and the transfer carries on from
+ * there. An offer with another transfer id replaces the transfer.
+ */
+class MQTTFirmware{
+private:
+    char ackTopic[FIRMWARE_MQTT_TOPIC_LEN];
+    char topic[FIRMWARE_MQTT_TOPIC_LEN];
+    publishSenderType sender;
+    FirmwareUpdate *update;
+
+    int state;
+    uint32_t transferId;
+    uint32_t length;
+    uint8_t sha256[32];
+    uint8_t expected[32];       // SHA-256 of the only image accepted
+    bool expecting;             // expected is set and not installed yet
+    uint32_t offset;            // bytes received in order
+    uint32_t acked;             // offset in the last ack
+    bool stalled;               // a chunk out of order has been answered
+    int result;                 // return code of the transfer
+
+    void offer(const uint8_t *msg, size_t len);
+    void chunk(const uint8_t *msg, size_t len);
+    void end(int rc);
+    int ack();
+    int sendAck(uint8_t ackState, uint32_t id, int rc);
+
+public:
+
+    /* Constructors */
+    MQTTFirmware(publishSenderType _sender);
+
+    /* Destructors */
+    ~MQTTFirmware();
+
+    /* Functions */
+
+    int setTopic(const char *_topic);
+
+    void expect(const uint8_t _sha256[32]);
+
+    const char *getTopic();
+
+    void receive(const void *payload, size_t payloadlen);
+
+    int resume();
+
+    int getState();
+
+    uint32_t getOffset();
+
+    uint32_t getLength();
+
+    int getResult();
+};
+
+#endif
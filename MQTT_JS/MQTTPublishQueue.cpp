@@ -0,0 +1,245 @@
+/*
+ * @file    MQTTPublishQueue.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Prioritized, rate limited outbound queue for MQTT publishes.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "MQTTPublishQueue.h"
+
+/** Constructor
+ * @brief	Constructor.
+ * @param	Function performing the actual publish
+ * @param	Largest packet the client can send, in bytes
+ */
+MQTTPublishQueue::MQTTPublishQueue(publishSenderType _sender, int _packetSize) : sender(_sender), packetSize(_packetSize){
+    queues[PRIORITY_HIGH].entries = highEntries;
+    queues[PRIORITY_HIGH].slots = PUBLISH_QUEUE_HIGH_SLOTS;
+    queues[PRIORITY_LOW].entries = lowEntries;
+    queues[PRIORITY_LOW].slots = PUBLISH_QUEUE_LOW_SLOTS;
+    for(int i = 0; i < PRIORITY_COUNT; i++){
+        queues[i].head = 0;
+        queues[i].count = 0;
+    }
+
+    rate = 0;
+    burst = 1;
+    tokens = 1000;
+    shedCount = 0;
+    dropCount = 0;
+
+    clock.start();
+    lastRefill = clock.read_ms();
+}
+
+/** setRateLimit
+ * @brief	Configures the token bucket pacing low priority messages.
+ * @param	Messages per second, 0 disables the limit
+ * @param	Largest burst of messages sent back to back
+ */
+void MQTTPublishQueue::setRateLimit(uint32_t _rate, uint32_t _burst){
+    rate = _rate;
+    burst = _burst ? _burst : 1;
+    tokens = burst * 1000;
+    lastRefill = clock.read_ms();
+}
+
+/** refill
+ * @brief	Adds the tokens earned since the last refill.
+ */
+void MQTTPublishQueue::refill(){
+    int now = clock.read_ms();
+    uint32_t elapsed = (uint32_t)(now - lastRefill);
+    lastRefill = now;
+
+    if(rate == 0){
+        return; // not rate limited
+    }
+    // elapsed ms * tokens/s gives thousandths of a token
+    uint32_t earned = elapsed * rate;
+    if(earned / rate != elapsed || tokens + earned > burst * 1000){
+        tokens = burst * 1000;
+    }
+    else{
+        tokens += earned;
+    }
+}
+
+/** find
+ * @brief	Looks for a queued message on a topic.
+ * @param	Queue
+ * @param	Topic
+ * @return  Queued entry, NULL if none
+ */
+MQTTPublishQueue::Entry *MQTTPublishQueue::find(Queue &queue, const char *topic){
+    for(int i = 0; i < queue.count; i++){
+        Entry *entry = &queue.entries[(queue.head + i) % queue.slots];
+        if(strcmp(entry->topic, topic) == 0){
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/** enqueue
+ * @brief	Queues a message for publishing.
+ * @param	Topic
+ * @param	Payload
+ * @param	Payload length
+ * @param	QoS
+ * @param	Priority class
+ * @return  Return code, BUFFER_OVERFLOW if the message does not fit in a packet
+ */
+int MQTTPublishQueue::enqueue(const char *topic, const void *payload, size_t payloadlen, MQTT::QoS qos, PublishPriority priority){
+    size_t topiclen = strlen(topic);
+    if(topiclen >= PUBLISH_QUEUE_TOPIC_LEN || payloadlen > PUBLISH_QUEUE_PAYLOAD_SIZE){
+        return MQTT::BUFFER_OVERFLOW;
+    }
+    // topic length, topic, packet id for QoS1 and up, payload
+    int remaining = 2 + topiclen + (qos != MQTT::QOS0 ? 2 : 0) + payloadlen;
+    if(MQTTPacket_len(remaining) > packetSize){
+        return MQTT::BUFFER_OVERFLOW; // would block its queue forever
+    }
+
+    Queue &queue = queues[priority];
+    Entry *entry = NULL;
+
+    if(priority == PRIORITY_LOW){
+        // Coalesce: only the latest reading of a topic is worth sending
+        entry = find(queue, topic);
+        if(!entry && queue.count == queue.slots){
+            queue.head = (queue.head + 1) % queue.slots; // shed the oldest reading
+            queue.count--;
+            shedCount++;
+        }
+    }
+    else if(queue.count == queue.slots){
+        return MQTT::FAILURE; // never drop latency sensitive messages silently
+    }
+
+    if(!entry){
+        entry = &queue.entries[(queue.head + queue.count) % queue.slots];
+        queue.count++;
+        strcpy(entry->topic, topic);
+    }
+    memcpy(entry->payload, payload, payloadlen);
+    entry->payloadlen = payloadlen;
+    entry->qos = qos;
+    return MQTT::SUCCESS;
+}
+
+/** send
+ * @brief	Publishes the oldest message of a queue, leaving it queued on a
+ *          failure that a retry can fix.
+ * @param	Queue
+ * @return  Return code
+ */
+int MQTTPublishQueue::send(Queue &queue){
+    Entry *entry = &queue.entries[queue.head];
+
+    MQTT::Message message;
+    message.qos = entry->qos;
+    message.retained = false;
+    message.dup = false;
+    message.payload = (void*)entry->payload;
+    message.payloadlen = entry->payloadlen;
+
+    int rc = sender(entry->topic, message);
+    if(rc == MQTT::BUFFER_OVERFLOW){
+        dropCount++;  // can never be sent, let the messages behind it go
+        rc = MQTT::SUCCESS;
+    }
+    else if(rc != MQTT::SUCCESS){
+        return rc;
+    }
+    queue.head = (queue.head + 1) % queue.slots;
+    queue.count--;
+    return rc;
+}
+
+/** service
+ * @brief	Sends all high priority messages, then as many low priority ones as the rate allows.
+ * @return  Return code of the first failed publish, 0 otherwise
+ */
+int MQTTPublishQueue::service(){
+    int rc = MQTT::SUCCESS;
+
+    refill();
+
+    Queue &high = queues[PRIORITY_HIGH];
+    while(high.count > 0){
+        if((rc = send(high)) != MQTT::SUCCESS){
+            return rc;
+        }
+        // High priority traffic is not held back, but still drains the bucket
+        tokens = (tokens > 1000) ? tokens - 1000 : 0;
+    }
+
+    Queue &low = queues[PRIORITY_LOW];
+    while(low.count > 0 && (rate == 0 || tokens >= 1000)){
+        if((rc = send(low)) != MQTT::SUCCESS){
+            return rc;
+        }
+        if(rate != 0){
+            tokens -= 1000;
+        }
+    }
+    return rc;
+}
+
+/** pending
+ * @brief	Returns the number of queued messages of a priority class.
+ * @param	Priority class
+ * @return  Number of messages
+ */
+int MQTTPublishQueue::pending(PublishPriority priority){
+    return queues[priority].count;
+}
+
+/** shed
+ * @brief	Returns the number of low priority messages dropped because their queue was full.
+ * @return  Number of messages
+ */
+uint32_t MQTTPublishQueue::shed(){
+    return shedCount;
+}
+
+/** dropped
+ * @brief	Returns the number of messages dropped because the client could not send them at all.
+ * @return  Number of messages
+ */
+uint32_t MQTTPublishQueue::dropped(){
+    return dropCount;
+}
@@ -0,0 +1,126 @@
+/*
+ * @file    MQTTPublishQueue.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Prioritized, rate limited outbound queue for MQTT publishes.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+
+#ifndef _MQTT_PUBLISH_QUEUE_H_
+#define _MQTT_PUBLISH_QUEUE_H_
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "MQTTClient.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+#define PUBLISH_QUEUE_TOPIC_LEN     32
+#define PUBLISH_QUEUE_PAYLOAD_SIZE  250
+#define PUBLISH_QUEUE_HIGH_SLOTS    4
+#define PUBLISH_QUEUE_LOW_SLOTS     8
+
+enum PublishPriority { PRIORITY_HIGH = 0, PRIORITY_LOW = 1, PRIORITY_COUNT };
+
+typedef Callback<int(const char *topic, MQTT::Message &message)> publishSenderType;
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Outbound scheduler sitting in front of MQTT::Client::publish.
+ *
+ * High priority messages are always sent first and are never shed.
+ * Low priority messages are paced by a token bucket; when their queue is
+ * full a newer value for a queued topic replaces the older one, otherwise
+ * the oldest queued message is dropped.
+ * A message that cannot fit in a packet is refused by enqueue(), and one
+ * the client still cannot serialize is dropped instead of blocking its queue.
+ */
+class MQTTPublishQueue{
+private:
+    struct Entry {
+        char topic[PUBLISH_QUEUE_TOPIC_LEN];
+        unsigned char payload[PUBLISH_QUEUE_PAYLOAD_SIZE];
+        size_t payloadlen;
+        MQTT::QoS qos;
+    };
+
+    struct Queue {
+        Entry *entries;
+        int slots;
+        int head;
+        int count;
+    };
+
+    Entry highEntries[PUBLISH_QUEUE_HIGH_SLOTS];
+    Entry lowEntries[PUBLISH_QUEUE_LOW_SLOTS];
+    Queue queues[PRIORITY_COUNT];
+
+    publishSenderType sender;
+    int packetSize;
+
+    Timer clock;
+    int lastRefill;
+    uint32_t rate;      // tokens per second, 0 for no limit
+    uint32_t burst;     // bucket size in tokens
+    uint32_t tokens;    // in thousandths of a token
+
+    uint32_t shedCount;
+    uint32_t dropCount;
+
+    void refill();
+    Entry *find(Queue &queue, const char *topic);
+    int send(Queue &queue);
+
+public:
+
+    /* Constructors */
+    MQTTPublishQueue(publishSenderType _sender, int _packetSize);
+
+    /* Functions */
+
+    void setRateLimit(uint32_t _rate, uint32_t _burst);
+
+    int enqueue(const char *topic, const void *payload, size_t payloadlen, MQTT::QoS qos, PublishPriority priority);
+
+    int service();
+
+    int pending(PublishPriority priority);
+
+    uint32_t shed();
+
+    uint32_t dropped();
+};
+
+#endif
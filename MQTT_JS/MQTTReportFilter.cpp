@@ -0,0 +1,245 @@
+/*
+ * @file    MQTTReportFilter.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Report-by-exception filter for MQTT publishes.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "MQTTReportFilter.h"
+
+#include <math.h>
+
+/** Constructor
+ * @brief	Constructor.
+ */
+MQTTReportFilter::MQTTReportFilter(){
+    memset(rules, 0, sizeof(rules));
+    clock.start();
+}
+
+/** find
+ * @brief	Looks up the rule of a topic.
+ * @param	Topic
+ * @return  Rule, NULL if the topic is not filtered
+ */
+MQTTReportFilter::Rule *MQTTReportFilter::find(const char *topic){
+    for(int i = 0; i < REPORT_FILTER_SLOTS; i++){
+        if(rules[i].topic[0] != '\0' && strcmp(rules[i].topic, topic) == 0){
+            return &rules[i];
+        }
+    }
+    return NULL;
+}
+
+/** setRule
+ * @brief	Installs or replaces the filter of a topic.
+ * @param	Topic
+ * @param	Deadband, smallest change of a numeric value worth reporting
+ * @param	Minimum interval between reports in ms, 0 for none
+ * @param	Maximum interval between reports in ms, 0 for none
+ * @return  Return code
+ */
+int MQTTReportFilter::setRule(const char *topic, float deadband, uint32_t minInterval, uint32_t maxInterval){
+    if(!topic || topic[0] == '\0' || strlen(topic) >= REPORT_FILTER_TOPIC_LEN){
+        return 1; // invalid topic
+    }
+
+    Rule *rule = find(topic);
+    for(int i = 0; !rule && i < REPORT_FILTER_SLOTS; i++){
+        if(rules[i].topic[0] == '\0'){
+            rule = &rules[i];
+        }
+    }
+    if(!rule){
+        return 2; // no free rule slot
+    }
+
+    memset(rule, 0, sizeof(Rule));
+    strcpy(rule->topic, topic);
+    rule->deadband = fabsf(deadband);
+    rule->minInterval = minInterval;
+    rule->maxInterval = maxInterval;
+    return 0;
+}
+
+/** clearRule
+ * @brief	Removes the filter of a topic.
+ * @param	Topic
+ * @return  Return code
+ */
+int MQTTReportFilter::clearRule(const char *topic){
+    Rule *rule = find(topic);
+    if(!rule){
+        return 1; // topic not filtered
+    }
+    rule->topic[0] = '\0';
+    return 0;
+}
+
+/** parseNumber
+ * @brief	Reads a payload made of a single number.
+ * @param	Payload
+ * @param	Payload length
+ * @param	Parsed value
+ * @return  True if the whole payload is a finite number
+ */
+bool MQTTReportFilter::parseNumber(const void *payload, size_t payloadlen, double *value){
+    char text[24];
+    char *end;
+
+    if(payloadlen == 0 || payloadlen >= sizeof(text)){
+        return false;
+    }
+    memcpy(text, payload, payloadlen);
+    text[payloadlen] = '\0';
+
+    *value = strtod(text, &end);
+    while(*end == ' ' || *end == '\r' || *end == '\n'){
+        end++;
+    }
+    // nan and inf compare unequal to everything, treat them as text
+    return end != text && *end == '\0' && isfinite(*value);
+}
+
+/** hash
+ * @brief	FNV-1a hash of a payload.
+ * @param	Payload
+ * @param	Payload length
+ * @return  Hash
+ */
+uint32_t MQTTReportFilter::hash(const void *payload, size_t payloadlen){
+    const unsigned char *data = (const unsigned char *)payload;
+    uint32_t h = 2166136261UL;
+    for(size_t i = 0; i < payloadlen; i++){
+        h = (h ^ data[i]) * 16777619UL;
+    }
+    return h;
+}
+
+/** changed
+ * @brief	Tells whether a payload differs from the last reported one.
+ * @param	Rule
+ * @param	Payload
+ * @param	Payload length
+ * @return  True if it is news
+ */
+bool MQTTReportFilter::changed(const Rule *rule, const void *payload, size_t payloadlen){
+    double value = 0;
+    bool numeric = parseNumber(payload, payloadlen, &value);
+    if(numeric && rule->numeric){
+        return fabs(value - rule->lastValue) > rule->deadband;
+    }
+    return numeric != rule->numeric || payloadlen != rule->lastLen ||
+        (!numeric && hash(payload, payloadlen) != rule->lastHash);
+}
+
+/** check
+ * @brief	Decides whether a payload is worth publishing, see commit().
+ *          A change that comes too soon after the last report is held, see due().
+ * @param	Topic
+ * @param	Payload
+ * @param	Payload length
+ * @param	Optional: caller data kept with a held payload
+ * @return  True if the payload should be published
+ */
+bool MQTTReportFilter::check(const char *topic, const void *payload, size_t payloadlen, uint8_t options){
+    Rule *rule = find(topic);
+    if(!rule || !rule->reported){
+        return true;
+    }
+
+    rule->held = false; // superseded by this value
+    uint32_t elapsed = (uint32_t)(clock.read_ms() - rule->lastReport);
+    if(rule->minInterval && elapsed < rule->minInterval){
+        // too soon after the last report, keep it for due() if it is news
+        if(payloadlen <= sizeof(rule->heldPayload) && changed(rule, payload, payloadlen)){
+            memcpy(rule->heldPayload, payload, payloadlen);
+            rule->heldLen = payloadlen;
+            rule->heldOptions = options;
+            rule->held = true;
+        }
+        return false;
+    }
+    if(rule->maxInterval && elapsed >= rule->maxInterval){
+        return true; // heartbeat
+    }
+    return changed(rule, payload, payloadlen);
+}
+
+/** due
+ * @brief	Hands back the payload held by a rule once its minimum interval
+ *          is over. It stays held until commit() or a newer check().
+ * @param	Rule slot, 0 to REPORT_FILTER_SLOTS - 1
+ * @param	Held payload
+ * @param	Held payload length
+ * @param	Caller data given to check()
+ * @return  Topic of the payload, NULL if nothing is due in the slot
+ */
+const char *MQTTReportFilter::due(int slot, const void **payload, size_t *payloadlen, uint8_t *options){
+    Rule *rule = &rules[slot];
+    if(rule->topic[0] == '\0' || !rule->held ||
+        (uint32_t)(clock.read_ms() - rule->lastReport) < rule->minInterval){
+        return NULL;
+    }
+    *payload = rule->heldPayload;
+    *payloadlen = rule->heldLen;
+    *options = rule->heldOptions;
+    return rule->topic;
+}
+
+/** commit
+ * @brief	Records a payload accepted by check() as reported, once it is queued.
+ * @param	Topic
+ * @param	Payload
+ * @param	Payload length
+ */
+void MQTTReportFilter::commit(const char *topic, const void *payload, size_t payloadlen){
+    Rule *rule = find(topic);
+    if(!rule){
+        return;
+    }
+
+    double value = 0;
+    bool numeric = parseNumber(payload, payloadlen, &value);
+    uint32_t h = numeric ? 0 : hash(payload, payloadlen);
+
+    rule->reported = true;
+    rule->numeric = numeric;
+    rule->lastValue = value;
+    rule->lastHash = h;
+    rule->lastLen = payloadlen;
+    rule->lastReport = clock.read_ms();
+    rule->held = false;
+}
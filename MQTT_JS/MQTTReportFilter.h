@@ -0,0 +1,111 @@
+/*
+ * @file    MQTTReportFilter.h
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Report-by-exception filter for MQTT publishes.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+
+#ifndef _MQTT_REPORT_FILTER_H_
+#define _MQTT_REPORT_FILTER_H_
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+
+/* Constants -----------------------------------------------------------------*/
+
+#define REPORT_FILTER_SLOTS      4
+#define REPORT_FILTER_TOPIC_LEN  32
+#define REPORT_FILTER_HELD_SIZE  250     // PUBLISH_QUEUE_PAYLOAD_SIZE
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Suppresses publishes that do not carry news.
+ *
+ * A value is reported when it moved by more than the deadband from the last
+ * reported value (numeric payloads) or differs from it (other payloads), but
+ * never more often than the minimum interval. Once the maximum interval has
+ * elapsed the next value is reported even if unchanged, as a heartbeat.
+ * The latest change that comes within the minimum interval is held and
+ * handed back by due() once the interval is over, so the last value of a
+ * burst still gets out.
+ * A value only counts as reported once commit() is called for it, so one
+ * that could not be queued does not hide the next identical one.
+ */
+class MQTTReportFilter{
+private:
+    struct Rule {
+        char topic[REPORT_FILTER_TOPIC_LEN];
+        float deadband;
+        uint32_t minInterval;   // ms, 0 for none
+        uint32_t maxInterval;   // ms, 0 for none
+        bool reported;
+        bool numeric;
+        double lastValue;
+        uint32_t lastHash;
+        size_t lastLen;
+        int lastReport;
+        bool held;
+        uint8_t heldOptions;
+        size_t heldLen;
+        unsigned char heldPayload[REPORT_FILTER_HELD_SIZE];
+    } rules[REPORT_FILTER_SLOTS];
+
+    Timer clock;
+
+    Rule *find(const char *topic);
+    static bool changed(const Rule *rule, const void *payload, size_t payloadlen);
+    static bool parseNumber(const void *payload, size_t payloadlen, double *value);
+    static uint32_t hash(const void *payload, size_t payloadlen);
+
+public:
+
+    /* Constructors */
+    MQTTReportFilter();
+
+    /* Functions */
+
+    int setRule(const char *topic, float deadband, uint32_t minInterval, uint32_t maxInterval);
+
+    int clearRule(const char *topic);
+
+    bool check(const char *topic, const void *payload, size_t payloadlen, uint8_t options = 0);
+
+    const char *due(int slot, const void **payload, size_t *payloadlen, uint8_t *options);
+
+    void commit(const char *topic, const void *payload, size_t payloadlen);
+};
+
+#endif
@@ -195,10 +195,27 @@ DECLARE_CLASS_FUNCTION(MQTT_JS, connect) {
  * MQTT_JS#publish (native JavaScript method)
  *
  * Publishes to the MQTT.
+ * Returns 0 once sent, 1 when the message is queued and will be sent on a
+ * later publish or yield (do not publish it again), negative on an error.
+ *
+ * @param data
+ * @param qos Optional, 0 (default) or 1
+ * @param priority Optional, 0 for high (alarms) or 1 for low (default, telemetry)
  */
 DECLARE_CLASS_FUNCTION(MQTT_JS, publish) {
-    CHECK_ARGUMENT_COUNT(MQTT_JS, subscribe, (args_count == 1));
-    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, subscribe, 0, string);
+    CHECK_ARGUMENT_COUNT(MQTT_JS, publish, (args_count >= 1 && args_count <= 3));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, publish, 0, string);
+    CHECK_ARGUMENT_TYPE_ON_CONDITION(MQTT_JS, publish, 1, number, (args_count >= 2));
+    CHECK_ARGUMENT_TYPE_ON_CONDITION(MQTT_JS, publish, 2, number, (args_count == 3));
+    
+    int qos = (args_count >= 2) ? (int)jerry_get_number_value(args[1]) : 0;
+    if(qos < MQTT::QOS0 || qos > MQTT::QOS1){
+        return jerry_create_number(MQTT::FAILURE);
+    }
+    int priority = (args_count == 3) ? (int)jerry_get_number_value(args[2]) : PRIORITY_LOW;
+    if(priority < PRIORITY_HIGH || priority > PRIORITY_LOW){
+        return jerry_create_number(MQTT::FAILURE);
+    }
     
     size_t buf_length = jerry_get_string_length(args[0]);
     
@@ -218,13 +235,502 @@ DECLARE_CLASS_FUNCTION(MQTT_JS, publish) {
 
     MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
 
-    int result = native_ptr->publish(buf);
+    int result = native_ptr->publish(buf, (MQTT::QoS)qos, (PublishPriority)priority);
 
     free(buf);
     return jerry_create_number(result);
 
 }
 
+/**
+ * MQTT_JS#setCleanSession (native JavaScript method)
+ *
+ * Selects a clean (default) or persistent session for the next connect.
+ * A persistent session is kept in flash and resumed after a power cycle.
+ *
+ * @param clean
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setCleanSession) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setCleanSession, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setCleanSession, 0, boolean);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->setCleanSession(jerry_get_boolean_value(args[0]));
+
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#saveSession (native JavaScript method)
+ *
+ * Snapshots the persistent session to flash, e.g. before powering down.
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, saveSession) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, saveSession, (args_count == 0));
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->saveSession();
+
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#publishObject (native JavaScript method)
+ *
+ * Publishes a JavaScript value encoded as CBOR, without going through JSON.stringify.
+ * The payload starts with the CBOR self-describe tag, so receivers can tell
+ * it from text. Returns the same codes as publish.
+ *
+ * @param value Object, array, string, number, boolean or null
+ * @param qos Optional, 0 (default) or 1
+ * @param priority Optional, 0 for high (alarms) or 1 for low (default, telemetry)
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, publishObject) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, publishObject, (args_count >= 1 && args_count <= 3));
+    CHECK_ARGUMENT_TYPE_ON_CONDITION(MQTT_JS, publishObject, 1, number, (args_count >= 2));
+    CHECK_ARGUMENT_TYPE_ON_CONDITION(MQTT_JS, publishObject, 2, number, (args_count == 3));
+
+    int qos = (args_count >= 2) ? (int)jerry_get_number_value(args[1]) : 0;
+    if(qos < MQTT::QOS0 || qos > MQTT::QOS1){
+        return jerry_create_number(MQTT::FAILURE);
+    }
+    int priority = (args_count == 3) ? (int)jerry_get_number_value(args[2]) : PRIORITY_LOW;
+    if(priority < PRIORITY_HIGH || priority > PRIORITY_LOW){
+        return jerry_create_number(MQTT::FAILURE);
+    }
+
+    unsigned char buf[PUBLISH_QUEUE_PAYLOAD_SIZE];
+    int buf_length = CborCodec::encode(args[0], buf, sizeof(buf), true);
+    if(buf_length < 0){
+        return jerry_create_number(MQTT::BUFFER_OVERFLOW);
+    }
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->publish(buf, buf_length, (MQTT::QoS)qos, (PublishPriority)priority);
+
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#setPayloadFormat (native JavaScript method)
+ *
+ * Selects how received payloads are passed to the onSubscribe callback.
+ * With "cbor", payloads that start with the CBOR self-describe tag (as sent
+ * by publishObject) are decoded, and all others still arrive as text.
+ *
+ * @param format "text" (default) or "cbor"
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setPayloadFormat) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setPayloadFormat, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setPayloadFormat, 0, string);
+
+    char format[8] = { 0 };
+    size_t format_length = jerry_get_string_length(args[0]);
+    if(format_length >= sizeof(format)){
+        return jerry_create_number(1);
+    }
+    jerry_string_to_char_buffer(args[0], (jerry_char_t*)format, format_length);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->setPayloadFormat(format);
+
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#setRateLimit (native JavaScript method)
+ *
+ * Limits the rate of low priority publishes.
+ *
+ * @param rate Messages per second, 0 disables the limit
+ * @param burst Largest burst of messages sent back to back
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setRateLimit) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setRateLimit, (args_count == 2));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setRateLimit, 0, number);
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setRateLimit, 1, number);
+
+    int rate = jerry_get_number_value(args[0]);
+    int burst = jerry_get_number_value(args[1]);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->setRateLimit(rate, burst);
+
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#setReportFilter (native JavaScript method)
+ *
+ * Suppresses repeated values of a topic before they reach the network.
+ *
+ * @param topic
+ * @param deadband Smallest change of a numeric value worth reporting
+ * @param minInterval Minimum time between reports in ms, 0 for none; the last change
+ *        within it is reported by yield once it is over
+ * @param maxInterval Time in ms after which an unchanged value is reported again, 0 for never
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setReportFilter) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setReportFilter, (args_count == 4));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setReportFilter, 0, string);
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setReportFilter, 1, number);
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setReportFilter, 2, number);
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setReportFilter, 3, number);
+
+    size_t topic_length = jerry_get_string_length(args[0]);
+
+    // add an extra character to ensure there's a null character after the topic
+    char* topic = (char*)calloc(topic_length + 1, sizeof(char));
+    jerry_string_to_char_buffer(args[0], (jerry_char_t*)topic, topic_length);
+
+    float deadband = jerry_get_number_value(args[1]);
+    int min_interval = jerry_get_number_value(args[2]);
+    int max_interval = jerry_get_number_value(args[3]);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        free(topic);
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->setReportFilter(topic, deadband, min_interval, max_interval);
+
+    free(topic);
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#clearReportFilter (native JavaScript method)
+ *
+ * Publishes every value of a topic again.
+ *
+ * @param topic
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, clearReportFilter) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, clearReportFilter, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, clearReportFilter, 0, string);
+
+    size_t topic_length = jerry_get_string_length(args[0]);
+
+    // add an extra character to ensure there's a null character after the topic
+    char* topic = (char*)calloc(topic_length + 1, sizeof(char));
+    jerry_string_to_char_buffer(args[0], (jerry_char_t*)topic, topic_length);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        free(topic);
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->clearReportFilter(topic);
+
+    free(topic);
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#setCompression (native JavaScript method)
+ *
+ * Compresses the payloads published on a topic.
+ *
+ * @param topic
+ * @param enabled
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setCompression) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setCompression, (args_count == 2));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setCompression, 0, string);
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setCompression, 1, boolean);
+
+    size_t topic_length = jerry_get_string_length(args[0]);
+
+    // add an extra character to ensure there's a null character after the topic
+    char* topic = (char*)calloc(topic_length + 1, sizeof(char));
+    jerry_string_to_char_buffer(args[0], (jerry_char_t*)topic, topic_length);
+
+    bool enabled = jerry_get_boolean_value(args[1]);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        free(topic);
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->setCompression(topic, enabled);
+
+    free(topic);
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#setFirmwareTopic (native JavaScript method)
+ *
+ * Receives a firmware update on a topic and installs it in the inactive slot.
+ * Anyone may publish on the topic, so only the image with the SHA-256 given
+ * here is installed. Take it from a source you trust, and call again with
+ * the next one for every update.
+ *
+ * @param topic Topic, the acks go to the topic followed by "/ack"
+ * @param sha256 SHA-256 of the image, 64 hex digits
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setFirmwareTopic) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setFirmwareTopic, (args_count == 2));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setFirmwareTopic, 0, string);
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setFirmwareTopic, 1, string);
+
+    size_t topic_length = jerry_get_string_length(args[0]);
+
+    // add an extra character to ensure there's a null character after the topic
+    char* topic = (char*)calloc(topic_length + 1, sizeof(char));
+    jerry_string_to_char_buffer(args[0], (jerry_char_t*)topic, topic_length);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        free(topic);
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    char sha256[65] = {0};
+    if (jerry_get_string_length(args[1]) < sizeof(sha256)) {
+        jerry_string_to_char_buffer(args[1], (jerry_char_t*)sha256, sizeof(sha256) - 1);
+    }
+
+    int result = native_ptr->setFirmwareTopic(topic, sha256);
+
+    free(topic);
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#firmwareStatus (native JavaScript method)
+ *
+ * Returns the state, offset, length and result of the firmware transfer,
+ * and the slot the next image has to be linked for, see FirmwareSlots.
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, firmwareStatus) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, firmwareStatus, (args_count == 0));
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    return native_ptr->getFirmwareStatus();
+}
+
+/**
+ * MQTT_JS#stats (native JavaScript method)
+ *
+ * Returns the client counters and the CONNACK, PUBACK and SUBACK latency histograms.
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, stats) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, stats, (args_count == 0));
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    return native_ptr->getStats();
+}
+
+/**
+ * MQTT_JS#setStatsTopic (native JavaScript method)
+ *
+ * Publishes the metrics periodically on a topic.
+ *
+ * @param topic Topic, empty to stop
+ * @param interval Interval in ms, 0 to stop
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setStatsTopic) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setStatsTopic, (args_count == 2));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setStatsTopic, 0, string);
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setStatsTopic, 1, number);
+
+    size_t topic_length = jerry_get_string_length(args[0]);
+
+    // add an extra character to ensure there's a null character after the topic
+    char* topic = (char*)calloc(topic_length + 1, sizeof(char));
+    jerry_string_to_char_buffer(args[0], (jerry_char_t*)topic, topic_length);
+
+    int interval = jerry_get_number_value(args[1]);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        free(topic);
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->setStatsTopic(topic, interval);
+
+    free(topic);
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#dumpTrace (native JavaScript method)
+ *
+ * Prints the latest MQTT packets, when built with MQTT_TRACE.
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, dumpTrace) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, dumpTrace, (args_count == 0));
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->dumpTrace();
+
+    return jerry_create_number(result);
+}
+
+/**
+ * MQTT_JS#setCA (native JavaScript method)
+ *
+ * Sets the CA certificates of the broker, when built with MQTT_USE_TLS.
+ *
+ * @param pem PEM encoded certificates
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, setCA) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, setCA, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, setCA, 0, string);
+
+    size_t pem_length = jerry_get_string_length(args[0]);
+
+    // add an extra character to ensure there's a null character after the certificates
+    char* pem = (char*)calloc(pem_length + 1, sizeof(char));
+    jerry_string_to_char_buffer(args[0], (jerry_char_t*)pem, pem_length);
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        free(pem);
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    int result = native_ptr->setCA(pem);
+
+    free(pem);
+    return jerry_create_number(result);
+}
+
 /**
  * MQTT_JS#run (native JavaScript method)
  *
@@ -318,6 +824,63 @@ DECLARE_CLASS_FUNCTION(MQTT_JS, subscribe) {
 }
 
 
+/**
+ * MQTT_JS#subscribeMany (native JavaScript method)
+ *
+ * Subscribes to several topics with a single SUBSCRIBE packet.
+ *
+ * @param topics Array of topic strings
+ */
+DECLARE_CLASS_FUNCTION(MQTT_JS, subscribeMany) {
+    CHECK_ARGUMENT_COUNT(MQTT_JS, subscribeMany, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(MQTT_JS, subscribeMany, 0, array);
+
+    uint32_t count = jerry_get_array_length(args[0]);
+    if(count == 0 || count > MQTT_MAX_SUBSCRIPTIONS){
+        return jerry_create_number(1);
+    }
+
+    char* topics[MQTT_MAX_SUBSCRIPTIONS] = { NULL };
+    int result = 0;
+    for(uint32_t i = 0; i < count; i++){
+        jerry_value_t item = jerry_get_property_by_index(args[0], i);
+        if(jerry_value_is_string(item)){
+            size_t topic_length = jerry_get_string_length(item);
+            topics[i] = (char*)calloc(topic_length + 1, sizeof(char));
+            jerry_string_to_char_buffer(item, (jerry_char_t*)topics[i], topic_length);
+        }
+        else{
+            result = 1; // invalid topic
+        }
+        jerry_release_value(item);
+    }
+
+    // Unwrap native MQTT_JS object
+    void *void_ptr;
+    const jerry_object_native_info_t *type_ptr;
+    bool has_ptr = jerry_get_object_native_pointer(this_obj, &void_ptr, &type_ptr);
+
+    if (!has_ptr || type_ptr != &native_obj_type_info) {
+        for(uint32_t i = 0; i < count; i++){
+            free(topics[i]);
+        }
+        return jerry_create_error(JERRY_ERROR_TYPE,
+                                  (const jerry_char_t *) "Failed to get native MQTT_JS pointer");
+    }
+
+    MQTT_JS *native_ptr = static_cast<MQTT_JS*>(void_ptr);
+
+    if(result == 0){
+        result = native_ptr->subscribeMany(topics, count);
+    }
+
+    for(uint32_t i = 0; i < count; i++){
+        free(topics[i]);
+    }
+    return jerry_create_number(result);
+}
+
+
 /**
  * MQTT_JS (native JavaScript constructor)
  *
@@ -336,8 +899,23 @@ DECLARE_CLASS_CONSTRUCTOR(MQTT_JS) {
     ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, onSubscribe);
     ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, init);
     ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, connect);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setCleanSession);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, saveSession);
     ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, subscribe);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, subscribeMany);
     ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, publish);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, publishObject);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setPayloadFormat);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setRateLimit);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setReportFilter);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, clearReportFilter);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setCompression);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setFirmwareTopic);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, firmwareStatus);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, stats);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setStatsTopic);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, dumpTrace);
+    ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, setCA);
     ATTACH_CLASS_FUNCTION(js_object, MQTT_JS, yield);
     
     return js_object;
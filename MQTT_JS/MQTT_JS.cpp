@@ -44,6 +44,16 @@
  */
 jerry_value_t MQTT_JS::onSubscribeCallback;
 
+/** decodeCbor
+ * @brief	Whether received payloads are decoded from CBOR before the callback.
+ */
+bool MQTT_JS::decodeCbor = false;
+
+/** firmwareReceiver
+ * @brief	Transfer the firmware topic is handed to.
+ */
+MQTTFirmware* MQTT_JS::firmwareReceiver = NULL;
+
 /** Constructor
  * @brief	Constructor.
  */
@@ -55,13 +65,31 @@ MQTT_JS::MQTT_JS(){
     mqttConnecting = false;
     netConnected = false;
     connected = false;
+    cleanSession = true;
+    sessionLoaded = false;
+    snapshotHasInflight = false;
     retryAttempt = 0;
 
     client = NULL;
     mqttNetwork = NULL;
+    caCert = NULL;
+    publishQueue = NULL;
+    firmware = NULL;
+    memset(subscriptions, 0, sizeof(subscriptions));
+    memset(compressedTopics, 0, sizeof(compressedTopics));
+
+    everConnected = false;
+    reconnects = 0;
+    publishRetries = 0;
+    filteredReports = 0;
+    statsTopic[0] = '\0';
+    statsInterval = 0;
     
     onSubscribeCallback = NULL;
-    
+
+#if defined(DEFERRED_LOG)
+    DeferredLog::start();  // the client logs through it from now on
+#endif
 }
 
 /** Destructor
@@ -76,6 +104,21 @@ MQTT_JS::~MQTT_JS(){
         delete mqttNetwork;
         mqttNetwork = NULL;
     }
+    if(publishQueue){
+        delete publishQueue;
+        publishQueue = NULL;
+    }
+    if(firmware){
+        if(firmwareReceiver == firmware){
+            firmwareReceiver = NULL;
+        }
+        delete firmware;
+        firmware = NULL;
+    }
+    if(caCert){
+        free(caCert);
+        caCert = NULL;
+    }
 }
 
 /** subscribe_cb
@@ -83,16 +126,46 @@ MQTT_JS::~MQTT_JS(){
  * @param	Message Data
  */
 void MQTT_JS::subscribe_cb(MQTT::MessageData & msgMQTT) {
-    char msg[MQTT_MAX_PAYLOAD_SIZE];
-    msg[0]='\0';
-    strncat (msg, (char*)msgMQTT.message.payload, msgMQTT.message.payloadlen);
-    //printf ("--->>> subscribe_cb msg: %s\n\r", msg);
+    //printf ("--->>> subscribe_cb msg: %.*s\n\r", msgMQTT.message.payloadlen, (char*)msgMQTT.message.payload);
 
     if (onSubscribeCallback && jerry_value_is_function(onSubscribeCallback)) {
-        
+
+        const unsigned char *data = (const unsigned char *)msgMQTT.message.payload;
+        int datalen = msgMQTT.message.payloadlen;
+
+        // the unpacked payload, then the text handed over, one buffer on this stack
+        unsigned char buf[MQTT_MAX_PAYLOAD_SIZE];
+        if (datalen >= 2 && data[0] == MQTT_COMPRESSED_MARKER && data[1] == MQTT_COMPRESSED_TAG) {
+            int len = LZSS::decompress(data + 2, datalen - 2, buf, sizeof(buf) - 1);
+            if (len < 0) {
+                printf("\33[31mDropping corrupt compressed message!\33[0m\n");
+                return;
+            }
+            data = buf;
+            datalen = len;
+        }
+
+        jerry_value_t payload = jerry_create_undefined ();
+        if (decodeCbor && CborCodec::isSelfDescribed(data, datalen)) {
+            payload = CborCodec::decode(data, datalen);
+            if (jerry_value_has_error_flag (payload)) {
+                printf("\33[31mDropping malformed CBOR message!\33[0m\n");
+                jerry_release_value (payload);
+                return;
+            }
+        }
+        else {
+            // not marked as CBOR, hand over the text as before
+            int len = datalen < (int)sizeof(buf) ? datalen : (int)sizeof(buf) - 1;
+            memmove(buf, data, len);  // data may already be buf
+            buf[len] = '\0';
+            jerry_release_value (payload);
+            payload = jerry_create_string ((const jerry_char_t *)buf);
+        }
+
         jerry_value_t this_val = jerry_create_undefined ();
         const jerry_value_t args[1] = {
-            jerry_create_string ((const jerry_char_t *)msg)
+            payload
             //jerry_create_number(3)
         };
 
@@ -110,6 +183,16 @@ void MQTT_JS::subscribe_cb(MQTT::MessageData & msgMQTT) {
     }
 }
 
+/** firmware_cb
+ * @brief	Hands a message from the firmware topic to the transfer.
+ * @param	Message Data
+ */
+void MQTT_JS::firmware_cb(MQTT::MessageData & msgMQTT) {
+    if (firmwareReceiver) {
+        firmwareReceiver->receive(msgMQTT.message.payload, msgMQTT.message.payloadlen);
+    }
+}
+
 /** onSubscribe
  * @brief	Calls the subscription callback.
  * @param	Jerry Callback
@@ -124,6 +207,48 @@ int MQTT_JS::onSubscribe(jerry_value_t cb){
     return 1;
 }
 
+/** addSubscription
+ * @brief	Stores a topic filter in a free subscription slot.
+ * @param	Topic filter
+ * @param	Set to whether the filter took a new slot, unless NULL
+ * @return  Stored filter, NULL if all slots are in use
+ */
+char* MQTT_JS::addSubscription(const char *filter, bool *added)
+{
+    char *free_slot = NULL;
+    if(added){
+        *added = false;
+    }
+    for(int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++){
+        if(strcmp(subscriptions[i], filter) == 0){
+            return subscriptions[i]; // already stored
+        }
+        if(!free_slot && subscriptions[i][0] == '\0'){
+            free_slot = subscriptions[i];
+        }
+    }
+    if(free_slot){
+        strcpy(free_slot, filter);
+        if(added){
+            *added = true;
+        }
+    }
+    return free_slot;
+}
+
+/** removeSubscription
+ * @brief	Releases the subscription slot of a topic filter.
+ * @param	Topic filter
+ */
+void MQTT_JS::removeSubscription(const char *filter)
+{
+    for(int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++){
+        if(strcmp(subscriptions[i], filter) == 0){
+            subscriptions[i][0] = '\0';
+        }
+    }
+}
+
 /** subscribe
  * @brief	Subscribes to the topic.
  * @param	Topic
@@ -131,11 +256,205 @@ int MQTT_JS::onSubscribe(jerry_value_t cb){
  */
 int MQTT_JS::subscribe (char *_topic)
 {
-    strcpy(topic, _topic);
-    if(!topic){
+    if(!_topic || strlen(_topic) >= MAX_TOPIC_LEN){
         return 1; // invalid topic
     }
-    return client->subscribe(topic, MQTT::QOS1, subscribe_cb);
+    strcpy(topic, _topic);
+    bool added;
+    char *filter = addSubscription(_topic, &added);
+    if(!filter){
+        return 2; // no free subscription slot
+    }
+    int rc = client->subscribe(filter, MQTT::QOS1, subscribe_cb);
+    if(rc != 0 && added){
+        // a slot that was there before stays, the client still points at it
+        removeSubscription(filter);
+    }
+    else if(!cleanSession){
+        saveSession();
+    }
+    return rc;
+}
+
+/** subscribeMany
+ * @brief	Subscribes to several topics with a single SUBSCRIBE packet.
+ * @param	Topics
+ * @param	Number of topics
+ * @return  Return code
+ */
+int MQTT_JS::subscribeMany(char **topics, int count)
+{
+    const char *filters[MQTT_MAX_SUBSCRIPTIONS];
+    MQTT::QoS qos[MQTT_MAX_SUBSCRIPTIONS];
+    int granted[MQTT_MAX_SUBSCRIPTIONS];
+    bool added[MQTT_MAX_SUBSCRIPTIONS];
+
+    if(count <= 0 || count > MQTT_MAX_SUBSCRIPTIONS){
+        return 1; // invalid topic count
+    }
+    for(int i = 0; i < count; i++){
+        if(!topics[i] || strlen(topics[i]) >= MAX_TOPIC_LEN){
+            return 1; // invalid topic
+        }
+    }
+    for(int i = 0; i < count; i++){
+        filters[i] = addSubscription(topics[i], &added[i]);
+        if(!filters[i]){
+            for(int j = 0; j < i; j++){
+                if(added[j]){
+                    removeSubscription(filters[j]);
+                }
+            }
+            return 2; // no free subscription slot
+        }
+        qos[i] = MQTT::QOS1;
+    }
+
+    int rc = client->subscribeMany(count, filters, qos, subscribe_cb, granted);
+    for(int i = 0; i < count; i++){
+        // only the slots this call added, the client still points at the others
+        if(added[i] && (rc != 0 || granted[i] == 0x80)){
+            removeSubscription(filters[i]);
+        }
+    }
+    if(rc == 0 && !cleanSession){
+        saveSession();
+    }
+    return rc;
+}
+
+/** restoreSubscriptions
+ * @brief	Brings the stored subscriptions back after a connect without a clean session.
+ * @param	Session present flag from the CONNACK
+ * @return  Return code
+ */
+int MQTT_JS::restoreSubscriptions(bool sessionPresent)
+{
+    char *filters[MQTT_MAX_SUBSCRIPTIONS];
+    int count = 0;
+
+    for(int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++){
+        if(subscriptions[i][0] != '\0'){
+            filters[count++] = subscriptions[i];
+        }
+    }
+    if(count == 0){
+        return 0;
+    }
+
+    if(!sessionPresent){
+        // The broker lost the session, subscribe again in a single round-trip
+        const char *requested[MQTT_MAX_SUBSCRIPTIONS];
+        MQTT::QoS qos[MQTT_MAX_SUBSCRIPTIONS];
+        for(int i = 0; i < count; i++){
+            requested[i] = filters[i];
+            qos[i] = MQTT::QOS1;
+        }
+        int rc = client->subscribeMany(count, requested, qos, subscribe_cb);
+        if(rc != 0){
+            return rc;
+        }
+    }
+
+    // The local handlers, the firmware topic has its own
+    for(int i = 0; i < count; i++){
+        bool isFirmware = firmware && strcmp(filters[i], firmware->getTopic()) == 0;
+        client->setMessageHandler(filters[i], isFirmware ? firmware_cb : subscribe_cb);
+    }
+    return 0;
+}
+
+/** resubscribeFirmware
+ * @brief	Subscribes the firmware topic again after a connect with a clean
+ *          session, which drops the subscription and its handler, so a
+ *          transfer can resume.
+ * @return  Return code
+ */
+int MQTT_JS::resubscribeFirmware()
+{
+    if(!firmware || firmware->getTopic()[0] == '\0'){
+        return 0;
+    }
+    char *filter = addSubscription(firmware->getTopic());
+    if(!filter){
+        return 2; // no free subscription slot
+    }
+    return client->subscribe(filter, MQTT::QOS1, firmware_cb);
+}
+
+/** setCleanSession
+ * @brief	Selects between a clean and a persistent session for the next connect.
+ * @param	Clean session flag
+ * @return  Return code
+ */
+int MQTT_JS::setCleanSession(bool clean)
+{
+    cleanSession = clean;
+    return 0;
+}
+
+/** saveSession
+ * @brief	Snapshots the subscriptions and the unacknowledged publish to flash.
+ * @return  Return code
+ */
+int MQTT_JS::saveSession()
+{
+    if(!client){
+        return -1;
+    }
+
+    MQTTSessionSnapshot *snapshot = new MQTTSessionSnapshot;
+    memset(snapshot, 0, sizeof(MQTTSessionSnapshot));
+    snapshot->magic = MQTT_SESSION_MAGIC;
+    strncpy(snapshot->clientId, id, sizeof(snapshot->clientId) - 1);
+    memcpy(snapshot->subscriptions, subscriptions, sizeof(subscriptions));
+    snapshot->inflightLen = client->getInflightPacket(snapshot->inflight);
+
+    FlashKV *kv = Flasher::get_kv();
+    uint32_t len = 0;
+    const void *stored = kv ? kv->get(MQTT_SESSION_KEY, &len) : NULL;
+    int rc;
+    if(stored && len == sizeof(MQTTSessionSnapshot) &&
+        memcmp(stored, snapshot, sizeof(MQTTSessionSnapshot)) == 0){
+        rc = 0; // unchanged, spare the flash
+    }
+    else{
+        rc = kv ? kv->set(MQTT_SESSION_KEY, snapshot, sizeof(MQTTSessionSnapshot)) : 1;
+    }
+    if(rc == 0){
+        snapshotHasInflight = (snapshot->inflightLen > 0);
+    }
+    delete snapshot;
+    return rc;
+}
+
+/** loadSession
+ * @brief	Restores the subscriptions and the unacknowledged publish from flash.
+ * @return  Return code
+ */
+int MQTT_JS::loadSession()
+{
+    FlashKV *kv = Flasher::get_kv();
+    uint32_t len = 0;
+    const MQTTSessionSnapshot *snapshot = kv ? (const MQTTSessionSnapshot *)kv->get(MQTT_SESSION_KEY, &len) : NULL;
+
+    sessionLoaded = true;
+    if(!snapshot || len != sizeof(MQTTSessionSnapshot) || snapshot->magic != MQTT_SESSION_MAGIC ||
+        strncmp(snapshot->clientId, id, sizeof(snapshot->clientId)) != 0){
+        return 1; // no session stored for this client
+    }
+
+    for(int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++){
+        if(snapshot->subscriptions[i][0] != '\0' &&
+            strlen(snapshot->subscriptions[i]) < MAX_TOPIC_LEN){
+            addSubscription(snapshot->subscriptions[i]);
+        }
+    }
+    if(snapshot->inflightLen > 0){
+        client->setInflightPacket(snapshot->inflight, snapshot->inflightLen);
+        snapshotHasInflight = true;
+    }
+    return 0;
 }
 
 /** unsubscribe
@@ -145,7 +464,14 @@ int MQTT_JS::subscribe (char *_topic)
  */
 int MQTT_JS::unsubscribe(char *pubTopic)
 {
-    return client->unsubscribe(pubTopic);
+    int rc = client->unsubscribe(pubTopic);
+    if(rc == 0){
+        removeSubscription(pubTopic);
+        if(!cleanSession){
+            saveSession();
+        }
+    }
+    return rc;
 }
 
 
@@ -171,9 +497,13 @@ int MQTT_JS::init(NetworkInterface* network, char* _id, char* _token, char* _url
         return -1;
     }
 
-    mqttNetwork = new MQTTNetwork(network);
+    mqttNetwork = new MQTTNetworkType(network);
+#if defined(MQTT_USE_TLS)
+    mqttNetwork->setCA(caCert);
+#endif
     
-    client = new MQTT::Client<MQTTNetwork, Countdown, MQTT_MAX_PACKET_SIZE>(*mqttNetwork);
+    client = new MQTTClientType(*mqttNetwork);
+    publishQueue = new MQTTPublishQueue(callback(this, &MQTT_JS::sendMessage), MQTT_MAX_PACKET_SIZE);
 
     return 0;
 }
@@ -205,10 +535,23 @@ int MQTT_JS::connect(NetworkInterface* network)
     data.username.cstring = id;
     data.password.cstring = auth_token;
     data.keepAliveInterval = 15;  // in Sec    
-    if ((rc = client->connect(data)) == 0) 
+    data.cleansession = cleanSession;
+    if (!cleanSession && !sessionLoaded)
+        loadSession();
+    MQTT::connackData connack;
+    if ((rc = client->connect(data, connack)) == 0) 
     {       
         connected = true;
+        if (everConnected)
+            reconnects++;
+        everConnected = true;
         printf ("--->MQTT Connected\n\r");     
+        if (!cleanSession)
+            restoreSubscriptions(connack.sessionPresent);
+        else
+            resubscribeFirmware();
+        if (firmware)
+            firmware->resume();  // the sender carries on from the offset reached
     }
     else {
         WARN("MQTT connect returned %d\n", rc);        
@@ -259,32 +602,114 @@ void MQTT_JS::attemptConnect(NetworkInterface* network)
     }
 }
 
+/** sendMessage
+ * @brief	Hands one message from the publish queue to the MQTT client.
+ * @param	Topic
+ * @param	Message
+ * @return  Return code
+ */
+int MQTT_JS::sendMessage(const char *pubTopic, MQTT::Message &message)
+{
+    //LOG("Publishing %.*s\n\r", message.payloadlen, (char*)message.payload);
+    int result = client->publish(pubTopic, message);
+    if(!cleanSession && (result != 0 || snapshotHasInflight)){
+        saveSession(); // keep the unacknowledged publish across power cycles
+    }
+    return result;
+}
+
+/** sendFirmwareAck
+ * @brief	Publishes a firmware transfer ack straight away, from the message
+ *          handler, so the sender can keep its window moving.
+ * @param	Topic
+ * @param	Message
+ * @return  Return code
+ */
+int MQTT_JS::sendFirmwareAck(const char *ackTopic, MQTT::Message &message)
+{
+    return client->publish(ackTopic, message);
+}
+
 /** publish
  * @brief	Publishes to the MQTT broker.
+ *          Values rejected by the report filter of the topic are dropped
+ *          before they are queued, except the last change within its
+ *          minimum interval, which yield sends once the interval is over.
+ *          High priority messages are sent ahead of any queued low priority
+ *          ones; low priority messages are paced by the rate limit and stay
+ *          queued until yield when the link is congested.
  * @param	Data
- * @param	Optional: retry number
- * @return  Return code
+ * @param	Optional: QoS
+ * @param	Optional: priority
+ * @return  Return code, MQTT_PUBLISH_QUEUED when the message is left
+ *          queued for the next publish or yield
  */
-int MQTT_JS::publish(char* buf, int n)
+int MQTT_JS::publish(char* buf, MQTT::QoS qos, PublishPriority priority)
 {
-    MQTT::Message message;
-    message.qos = MQTT::QOS0;
-    message.retained = false;
-    message.dup = false;
-    message.payload = (void*)buf;
-    message.payloadlen = strlen(buf);
-    
-    //LOG("Publishing %s\n\r", buf);
-    int result =  client->publish(topic, message);
-    if(result != 0){
-        if(n < 2){
-            printf("\33[31mCould not publish message. Trying again...\33[0m\n");
-            return publish(buf, n+1);
+    return publish(buf, strlen(buf), qos, priority);
+}
+
+/** publish
+ * @brief	Publishes a binary payload to the MQTT broker.
+ * @param	Payload
+ * @param	Payload length
+ * @param	QoS
+ * @param	Priority
+ * @return  Return code, see above
+ */
+int MQTT_JS::publish(const void* payload, size_t payloadlen, MQTT::QoS qos, PublishPriority priority)
+{
+    if(!reportFilter.check(topic, payload, payloadlen, (uint8_t)(qos | (priority << 2)))){
+        filteredReports++;
+        return 0; // nothing new to report, or held until the minimum interval is over
+    }
+    return report(topic, payload, payloadlen, qos, priority);
+}
+
+/** report
+ * @brief	Queues a payload the report filter let through and sends what
+ *          the rate limit allows.
+ * @param	Topic
+ * @param	Payload
+ * @param	Payload length
+ * @param	QoS
+ * @param	Priority
+ * @return  Return code, see publish()
+ */
+int MQTT_JS::report(const char *pubTopic, const void* payload, size_t payloadlen, MQTT::QoS qos, PublishPriority priority)
+{
+    const void *value = payload;
+    size_t valuelen = payloadlen;
+    unsigned char packed[PUBLISH_QUEUE_PAYLOAD_SIZE];
+    if(isCompressed(pubTopic)){
+        packed[0] = MQTT_COMPRESSED_MARKER;
+        packed[1] = MQTT_COMPRESSED_TAG;
+        int len = LZSS::compress((const uint8_t *)payload, payloadlen, packed + 2, sizeof(packed) - 2);
+        if(len >= 0 && (size_t)len + 2 < payloadlen){
+            // only worth it when the envelope comes out smaller
+            payload = packed;
+            payloadlen = len + 2;
         }
-        else{
-            printf("\33[31mError publishing message!\33[0m\n");
-            return result;
+    }
+
+    int result = publishQueue->enqueue(pubTopic, payload, payloadlen, qos, priority);
+    if(result != 0){
+        printf("\33[31mError queuing message!\33[0m\n");
+        return result;  // not reported, an identical value may follow
+    }
+    reportFilter.commit(pubTopic, value, valuelen);
+
+    result = publishQueue->service();
+    if(result != 0){
+        publishRetries++;
+        // the message stays queued and is retried on the next publish or yield
+        printf("\33[31mCould not publish message. Will try again...\33[0m\n");
+        // a low priority message waits behind any failure, a high priority
+        // one only when the high queue did not drain
+        if(priority == PRIORITY_LOW || publishQueue->pending(PRIORITY_HIGH) > 0){
+            return MQTT_PUBLISH_QUEUED;
         }
+        result = 0;
     }
     
     /*
@@ -295,6 +720,395 @@ int MQTT_JS::publish(char* buf, int n)
     return result;
 } 
 
+/** setPayloadFormat
+ * @brief	Selects how received payloads are handed to the subscription callback.
+ *          "cbor" decodes the payloads marked with the self-describe tag.
+ * @param	"text" (default) or "cbor"
+ * @return  Return code
+ */
+int MQTT_JS::setPayloadFormat(const char* format)
+{
+    if(strcmp(format, "cbor") == 0){
+        decodeCbor = true;
+    }
+    else if(strcmp(format, "text") == 0){
+        decodeCbor = false;
+    }
+    else{
+        return 1; // unknown format
+    }
+    return 0;
+}
+
+/** setRateLimit
+ * @brief	Limits the rate of low priority publishes.
+ * @param	Messages per second, 0 disables the limit
+ * @param	Largest burst of messages sent back to back
+ * @return  Return code
+ */
+int MQTT_JS::setRateLimit(int rate, int burst)
+{
+    if(!publishQueue || rate < 0 || burst < 0){
+        return -1;
+    }
+    publishQueue->setRateLimit(rate, burst);
+    return 0;
+}
+
+
+/** setReportFilter
+ * @brief	Only publishes new values of a topic: changes beyond the deadband,
+ *          no faster than the minimum interval, and at least every maximum interval.
+ * @param	Topic
+ * @param	Deadband
+ * @param	Minimum interval in ms, 0 for none
+ * @param	Maximum interval in ms, 0 for none
+ * @return  Return code
+ */
+int MQTT_JS::setReportFilter(char *pubTopic, float deadband, int minInterval, int maxInterval)
+{
+    if(minInterval < 0 || maxInterval < 0){
+        return -1;
+    }
+    return reportFilter.setRule(pubTopic, deadband, minInterval, maxInterval);
+}
+
+/** clearReportFilter
+ * @brief	Publishes every value of a topic again.
+ * @param	Topic
+ * @return  Return code
+ */
+int MQTT_JS::clearReportFilter(char *pubTopic)
+{
+    return reportFilter.clearRule(pubTopic);
+}
+
+/** setCompression
+ * @brief	Compresses the payloads published on a topic. Receivers recognise
+ *          compressed payloads by their envelope, whatever their own setting.
+ * @param	Topic
+ * @param	Enable or disable
+ * @return  Return code
+ */
+int MQTT_JS::setCompression(char *pubTopic, bool enabled)
+{
+    if(pubTopic[0] == '\0' || strlen(pubTopic) >= MAX_TOPIC_LEN){
+        return 1;
+    }
+    char *free_slot = NULL;
+    for(int i = 0; i < MQTT_MAX_COMPRESSED_TOPICS; i++){
+        if(strcmp(compressedTopics[i], pubTopic) == 0){
+            if(!enabled){
+                compressedTopics[i][0] = '\0';
+            }
+            return 0;
+        }
+        if(free_slot == NULL && compressedTopics[i][0] == '\0'){
+            free_slot = compressedTopics[i];
+        }
+    }
+    if(!enabled){
+        return 0;
+    }
+    if(free_slot == NULL){
+        return 2; // no room for another topic
+    }
+    strcpy(free_slot, pubTopic);
+    return 0;
+}
+
+/** setFirmwareTopic
+ * @brief	Receives a firmware update on a topic, see MQTTFirmware. The acks
+ *          go to the topic followed by "/ack". Only the image with the given
+ *          SHA-256 is installed, the hash in the offer is not trusted.
+ * @param	Topic
+ * @param	SHA-256 of the image, 64 hex digits
+ * @return  Return code
+ */
+int MQTT_JS::setFirmwareTopic(char *fwTopic, char *sha256Hex)
+{
+    uint8_t sha256[32];
+
+    if(!client){
+        return -1;
+    }
+    if(!fwTopic || fwTopic[0] == '\0' ||
+        strlen(fwTopic) + strlen(FIRMWARE_MQTT_ACK_SUFFIX) >= MAX_TOPIC_LEN){
+        return 1; // invalid topic
+    }
+    if(!sha256Hex || strlen(sha256Hex) != 2 * sizeof(sha256)){
+        return 3; // invalid hash
+    }
+    for(size_t i = 0; i < sizeof(sha256); i++){
+        unsigned int byte;
+        if(!isxdigit((unsigned char)sha256Hex[2 * i]) || !isxdigit((unsigned char)sha256Hex[2 * i + 1]) ||
+            sscanf(sha256Hex + 2 * i, "%2x", &byte) != 1){
+            return 3; // invalid hash
+        }
+        sha256[i] = byte;
+    }
+    if(!firmware){
+        firmware = new MQTTFirmware(callback(this, &MQTT_JS::sendFirmwareAck));
+        firmwareReceiver = firmware;
+    }
+
+    const char *previous = firmware->getTopic();
+    if(previous[0] != '\0' && strcmp(previous, fwTopic) != 0){
+        unsubscribe((char*)previous);
+    }
+    firmware->setTopic(fwTopic);
+    firmware->expect(sha256);
+
+    bool added;
+    char *filter = addSubscription(fwTopic, &added);
+    if(!filter){
+        return 2; // no free subscription slot
+    }
+    int rc = client->subscribe(filter, MQTT::QOS1, firmware_cb);
+    if(rc != 0 && added){
+        removeSubscription(filter);
+    }
+    else if(!cleanSession){
+        saveSession();
+    }
+    return rc;
+}
+
+/** setNumber
+ * @brief	Sets a numeric property of a Javascript object.
+ * @param	Object
+ * @param	Property name
+ * @param	Value
+ */
+static void setNumber(jerry_value_t object, const char *name, double value)
+{
+    jerry_value_t key = jerry_create_string((const jerry_char_t *)name);
+    jerry_value_t number = jerry_create_number(value);
+    jerry_release_value(jerry_set_property(object, key, number));
+    jerry_release_value(number);
+    jerry_release_value(key);
+}
+
+/** setObject
+ * @brief	Sets a property of a Javascript object and releases the value.
+ * @param	Object
+ * @param	Property name
+ * @param	Value
+ */
+static void setObject(jerry_value_t object, const char *name, jerry_value_t value)
+{
+    jerry_value_t key = jerry_create_string((const jerry_char_t *)name);
+    jerry_release_value(jerry_set_property(object, key, value));
+    jerry_release_value(value);
+    jerry_release_value(key);
+}
+
+/** createHistogram
+ * @brief	Converts a latency histogram to a Javascript object.
+ * @param	Histogram
+ * @return  Object with count, average, max and buckets
+ */
+static jerry_value_t createHistogram(const MQTT::LatencyHistogram &histogram)
+{
+    jerry_value_t object = jerry_create_object();
+    setNumber(object, "count", histogram.count);
+    setNumber(object, "average", histogram.average_ms());
+    setNumber(object, "max", histogram.max_ms);
+
+    jerry_value_t buckets = jerry_create_array(MQTT_LATENCY_BUCKETS);
+    for(uint32_t i = 0; i < MQTT_LATENCY_BUCKETS; i++){
+        jerry_value_t number = jerry_create_number(histogram.buckets[i]);
+        jerry_release_value(jerry_set_property_by_index(buckets, i, number));
+        jerry_release_value(number);
+    }
+    setObject(object, "buckets", buckets);
+    return object;
+}
+
+/** getStats
+ * @brief	Collects the client counters and latency histograms.
+ * @return  Javascript object
+ */
+jerry_value_t MQTT_JS::getStats()
+{
+    jerry_value_t stats = jerry_create_object();
+    if(client == NULL){
+        return stats;
+    }
+    MQTT::Metrics metrics = client->getMetrics();  // copy, the client keeps updating its own
+
+    setNumber(stats, "bytesSent", metrics.bytesSent);
+    setNumber(stats, "bytesReceived", metrics.bytesReceived);
+    setNumber(stats, "packetsSent", metrics.packetsSent);
+    setNumber(stats, "packetsReceived", metrics.packetsReceived);
+    setNumber(stats, "publishes", metrics.publishes);
+    setNumber(stats, "publishFailures", metrics.publishFailures);
+    setNumber(stats, "publishRetries", publishRetries);
+    setNumber(stats, "messagesReceived", metrics.messagesReceived);
+    setNumber(stats, "connects", metrics.connects);
+    setNumber(stats, "connectFailures", metrics.connectFailures);
+    setNumber(stats, "reconnects", reconnects);
+    setNumber(stats, "keepaliveFailures", metrics.keepaliveFailures);
+    setNumber(stats, "bufferOverflows", metrics.bufferOverflows);
+    setNumber(stats, "filtered", filteredReports);
+    setNumber(stats, "shed", publishQueue->shed());
+    setNumber(stats, "dropped", publishQueue->dropped());
+    setNumber(stats, "queued", publishQueue->pending(PRIORITY_HIGH) + publishQueue->pending(PRIORITY_LOW));
+
+    jerry_value_t latency = jerry_create_object();
+    jerry_value_t bounds = jerry_create_array(MQTT_LATENCY_BUCKETS - 1);
+    for(uint32_t i = 0; i < MQTT_LATENCY_BUCKETS - 1; i++){
+        jerry_value_t number = jerry_create_number(MQTT::latencyBucketBounds[i]);
+        jerry_release_value(jerry_set_property_by_index(bounds, i, number));
+        jerry_release_value(number);
+    }
+    setObject(latency, "bounds", bounds);
+    setObject(latency, "connack", createHistogram(metrics.connack));
+    setObject(latency, "puback", createHistogram(metrics.puback));
+    setObject(latency, "suback", createHistogram(metrics.suback));
+    setObject(stats, "latency", latency);
+
+#if defined(MQTT_USE_TLS)
+    MQTT::TLSMetrics tlsMetrics = mqttNetwork->getMetrics();
+    jerry_value_t tls = jerry_create_object();
+    setNumber(tls, "fullHandshakes", tlsMetrics.fullHandshakes);
+    setNumber(tls, "resumedHandshakes", tlsMetrics.resumedHandshakes);
+    setNumber(tls, "handshakeFailures", tlsMetrics.handshakeFailures);
+    setObject(tls, "full", createHistogram(tlsMetrics.full));
+    setObject(tls, "resumed", createHistogram(tlsMetrics.resumed));
+    setObject(stats, "tls", tls);
+#endif
+
+    return stats;
+}
+
+/** getFirmwareStatus
+ * @brief	Reports the progress of the firmware transfer.
+ * @return  Javascript object with state, offset, length and result, and the
+ *          slot the next image has to be linked for
+ */
+jerry_value_t MQTT_JS::getFirmwareStatus()
+{
+    jerry_value_t status = jerry_create_object();
+    setNumber(status, "slot", FirmwareSlots::get_inactive_slot());
+    if(firmware == NULL){
+        setNumber(status, "state", TRANSFER_IDLE);
+        return status;
+    }
+    setNumber(status, "state", firmware->getState());
+    setNumber(status, "offset", firmware->getOffset());
+    setNumber(status, "length", firmware->getLength());
+    setNumber(status, "result", firmware->getResult());
+    return status;
+}
+
+/** setStatsTopic
+ * @brief	Publishes the metrics periodically as a JSON document, from yield.
+ * @param	Topic, empty to stop
+ * @param	Interval in ms, 0 to stop
+ * @return  Return code
+ */
+int MQTT_JS::setStatsTopic(char *pubTopic, int interval)
+{
+    if(strlen(pubTopic) >= MAX_TOPIC_LEN || interval < 0){
+        return 1;
+    }
+    strcpy(statsTopic, pubTopic);
+    statsInterval = (statsTopic[0] != '\0') ? interval : 0;
+    statsTimer.reset();
+    statsTimer.start();
+    return 0;
+}
+
+/** dumpTrace
+ * @brief	Prints the packet trace ring for tools/mqtt_trace_decode.
+ * @return  Return code, 1 if built without MQTT_TRACE
+ */
+int MQTT_JS::dumpTrace()
+{
+#if defined(MQTT_TRACE)
+    if(client == NULL){
+        return 2;
+    }
+    client->getTrace().dump(stdout);
+    return 0;
+#else
+    return 1;
+#endif
+}
+
+/** setCA
+ * @brief	Sets the CA certificates the broker is verified against.
+ * @param	PEM encoded certificates
+ * @return  Return code, 1 if built without MQTT_USE_TLS
+ */
+int MQTT_JS::setCA(const char *pem)
+{
+#if defined(MQTT_USE_TLS)
+    char *copy = (char*)malloc(strlen(pem) + 1);
+    if(copy == NULL){
+        return 2;
+    }
+    strcpy(copy, pem);
+    if(mqttNetwork){
+        mqttNetwork->setCA(copy);
+    }
+    if(caCert){
+        free(caCert);
+    }
+    caCert = copy;
+    return 0;
+#else
+    return 1;
+#endif
+}
+
+/** publishStats
+ * @brief	Queues the metrics on the stats topic.
+ * @return  Return code
+ */
+int MQTT_JS::publishStats()
+{
+    MQTT::Metrics metrics = client->getMetrics();
+    char buf[PUBLISH_QUEUE_PAYLOAD_SIZE];
+
+    int len = snprintf(buf, sizeof(buf),
+        "{\"tx\":%lu,\"rx\":%lu,\"pub\":%lu,\"pubFail\":%lu,\"retry\":%lu,\"shed\":%lu,"
+        "\"reconnect\":%lu,\"keepalive\":%lu,\"overflow\":%lu,"
+        "\"connack\":[%lu,%lu,%lu],\"puback\":[%lu,%lu,%lu],\"suback\":[%lu,%lu,%lu]}",
+        (unsigned long)metrics.bytesSent, (unsigned long)metrics.bytesReceived,
+        (unsigned long)metrics.publishes, (unsigned long)metrics.publishFailures,
+        (unsigned long)publishRetries, (unsigned long)publishQueue->shed(),
+        (unsigned long)reconnects, (unsigned long)metrics.keepaliveFailures,
+        (unsigned long)metrics.bufferOverflows,
+        (unsigned long)metrics.connack.count, (unsigned long)metrics.connack.average_ms(), (unsigned long)metrics.connack.max_ms,
+        (unsigned long)metrics.puback.count, (unsigned long)metrics.puback.average_ms(), (unsigned long)metrics.puback.max_ms,
+        (unsigned long)metrics.suback.count, (unsigned long)metrics.suback.average_ms(), (unsigned long)metrics.suback.max_ms);
+    if(len < 0 || len >= (int)sizeof(buf)){
+        return 1;
+    }
+    // bypasses the report filter and compression, and coalesces with an unsent previous report
+    return publishQueue->enqueue(statsTopic, buf, len, MQTT::QOS0, PRIORITY_LOW);
+}
+
+/** isCompressed
+ * @brief	Tells whether payloads of a topic are compressed.
+ * @param	Topic
+ * @return  True if compressed
+ */
+bool MQTT_JS::isCompressed(const char *pubTopic)
+{
+    if(pubTopic[0] == '\0'){
+        return false;
+    }
+    for(int i = 0; i < MQTT_MAX_COMPRESSED_TOPICS; i++){
+        if(strcmp(compressedTopics[i], pubTopic) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
 
 /** yield
  * @brief	Waits for the MQTT broker for subscription callback.
@@ -303,6 +1117,23 @@ int MQTT_JS::publish(char* buf, int n)
  */
 int MQTT_JS::yield(int time)
 {
+    if(statsInterval > 0 && statsTimer.read_ms() >= statsInterval){
+        statsTimer.reset();
+        publishStats();
+    }
+    for(int i = 0; i < REPORT_FILTER_SLOTS; i++){
+        // the last change held back by a minimum interval
+        const void *payload;
+        size_t payloadlen;
+        uint8_t options;
+        const char *heldTopic = reportFilter.due(i, &payload, &payloadlen, &options);
+        if(heldTopic){
+            report(heldTopic, payload, payloadlen, (MQTT::QoS)(options & 3), (PublishPriority)(options >> 2));
+        }
+    }
+    if(publishQueue->service() != 0){  // drain what the rate limit allows by now
+        publishRetries++;
+    }
     client->yield(time);  // allow the MQTT client to receive messages
     return 0;
 } 
@@ -325,9 +1156,13 @@ int MQTT_JS::start_mqtt(NetworkInterface* network)
         return -1;
     }
 
-    mqttNetwork = new MQTTNetwork(network);
+    mqttNetwork = new MQTTNetworkType(network);
+#if defined(MQTT_USE_TLS)
+    mqttNetwork->setCA(caCert);
+#endif
     
-    client = new MQTT::Client<MQTTNetwork, Countdown, MQTT_MAX_PACKET_SIZE>(*mqttNetwork);
+    client = new MQTTClientType(*mqttNetwork);
+    publishQueue = new MQTTPublishQueue(callback(this, &MQTT_JS::sendMessage), MQTT_MAX_PACKET_SIZE);
 
     attemptConnect(network);   
     if (connack_rc == MQTT_NOT_AUTHORIZED || connack_rc == MQTT_BAD_USERNAME_OR_PASSWORD)    
@@ -46,8 +46,14 @@
 #include "MQTTClient.h"
 #include "MQTTNetwork.h"
 #include "MQTTmbed.h"
+#include "MQTTPublishQueue.h"
+#include "MQTTReportFilter.h"
+#include "MQTTFirmware.h"
+#include "CborCodec.h"
+#include "LZSS.h"
 
 #include "NetworkInterface_JS.h"
+#include "Flasher.h"
 
 #include "jerryscript-mbed-library-registry/wrap_tools.h"
 
@@ -57,14 +63,48 @@
 
 #define MQTT_MAX_PACKET_SIZE 250
 #define MQTT_MAX_PAYLOAD_SIZE 300
+#define MQTT_MAX_SUBSCRIPTIONS 5
+#define MAX_TOPIC_LEN  32
+
+#define MQTT_PUBLISH_QUEUED 1 // publish() left the message queued for a later publish or yield
 
 #define MAX_SSID_LEN   80
 #define MAX_PASSW_LEN  80
 
 #define HTTP_BROKER_URL "http://customer.cloudmqtt.com/login"
 
+#define MQTT_SESSION_MAGIC 0x4D515353 // "MQSS"
+#define MQTT_SESSION_KEY   "mqtt.session"
+
+#define MQTT_MAX_COMPRESSED_TOPICS 4
+#define MQTT_COMPRESSED_MARKER 0xFF  // never starts a text or CBOR payload
+#define MQTT_COMPRESSED_TAG    'Z'
+
 typedef void (* subscribeCallbackType)(MQTT::MessageData & msgMQTT);
 
+/**
+ * Transport of the MQTT connection, plain TCP unless built with MQTT_USE_TLS.
+ */
+#if defined(MQTT_USE_TLS)
+#include "MQTTTLSNetwork.h"
+typedef MQTTTLSNetwork MQTTNetworkType;
+#else
+typedef MQTTNetwork MQTTNetworkType;
+#endif
+typedef MQTT::Client<MQTTNetworkType, Countdown, MQTT_MAX_PACKET_SIZE, MQTT_MAX_SUBSCRIPTIONS> MQTTClientType;
+
+/**
+ * Persistent session snapshot kept in the Flasher key-value store when
+ * connecting with cleansession=0.
+ */
+struct MQTTSessionSnapshot {
+    uint32_t magic;
+    char clientId[32];
+    char subscriptions[MQTT_MAX_SUBSCRIPTIONS][MAX_TOPIC_LEN];
+    int inflightLen;
+    unsigned char inflight[MQTT_MAX_PACKET_SIZE];
+};
+
 /* Class Declaration ---------------------------------------------------------*/
 
 /**
@@ -76,7 +116,7 @@ private:
     char seckey[MAX_PASSW_LEN]; 
 
     char id[32];
-    char topic[32];
+    char topic[MAX_TOPIC_LEN];
     char auth_token[32];
     char hostname[128];
     char port[16];
@@ -89,12 +129,41 @@ private:
     bool mqttConnecting;
     bool netConnected;
     bool connected;
+    bool cleanSession;
+    bool sessionLoaded;
+    bool snapshotHasInflight;
     int retryAttempt;
     char subscription_url[300];
-    MQTT::Client<MQTTNetwork, Countdown, MQTT_MAX_PACKET_SIZE>* client;
-    MQTTNetwork* mqttNetwork;
+    char subscriptions[MQTT_MAX_SUBSCRIPTIONS][MAX_TOPIC_LEN]; // topic filters referenced by the client handlers
+    MQTTClientType* client;
+    MQTTNetworkType* mqttNetwork;
+    char* caCert;
+    MQTTPublishQueue* publishQueue;
+    MQTTReportFilter reportFilter;
+    char compressedTopics[MQTT_MAX_COMPRESSED_TOPICS][MAX_TOPIC_LEN];
+    MQTTFirmware* firmware;
+
+    bool everConnected;
+    uint32_t reconnects;
+    uint32_t publishRetries;  // publishes left queued for another attempt
+    uint32_t filteredReports;
+    char statsTopic[MAX_TOPIC_LEN];
+    int statsInterval;
+    Timer statsTimer;
 
     static jerry_value_t onSubscribeCallback;
+    static bool decodeCbor;
+    static MQTTFirmware* firmwareReceiver;
+
+    char* addSubscription(const char *filter, bool *added = NULL);
+    void removeSubscription(const char *filter);
+    int restoreSubscriptions(bool sessionPresent);
+    int resubscribeFirmware();
+    int sendMessage(const char *pubTopic, MQTT::Message &message);
+    int sendFirmwareAck(const char *ackTopic, MQTT::Message &message);
+    bool isCompressed(const char *pubTopic);
+    int report(const char *pubTopic, const void* payload, size_t payloadlen, MQTT::QoS qos, PublishPriority priority);
+    int publishStats();
 
 public:
 
@@ -113,21 +182,55 @@ public:
 
     static void subscribe_cb(MQTT::MessageData & msgMQTT);
 
+    static void firmware_cb(MQTT::MessageData & msgMQTT);
+
     int init(NetworkInterface* network, char* _id, char* _token, char* _url, char* _port);
 
     int connect();
 
     int subscribe(char *pubTopic);
 
+    int subscribeMany(char **topics, int count);
+
     int unsubscribe(char *pubTopic);
 
     int connect(NetworkInterface* network);
 
+    int setCleanSession(bool clean);
+
+    int saveSession();
+
+    int loadSession();
+
     int getConnTimeout(int attemptNumber);
 
     void attemptConnect(NetworkInterface* network) ;
 
-    int publish(char* buf, int n = 0);
+    int publish(char* buf, MQTT::QoS qos = MQTT::QOS0, PublishPriority priority = PRIORITY_LOW);
+
+    int publish(const void* payload, size_t payloadlen, MQTT::QoS qos, PublishPriority priority);
+
+    int setPayloadFormat(const char* format);
+
+    int setRateLimit(int rate, int burst);
+
+    int setReportFilter(char *pubTopic, float deadband, int minInterval, int maxInterval);
+
+    int clearReportFilter(char *pubTopic);
+
+    int setCompression(char *pubTopic, bool enabled);
+
+    int setFirmwareTopic(char *fwTopic, char *sha256Hex);
+
+    jerry_value_t getFirmwareStatus();
+
+    jerry_value_t getStats();
+
+    int setStatsTopic(char *pubTopic, int interval);
+
+    int dumpTrace();
+
+    int setCA(const char *pem);
 
     int yield(int time);
 
@@ -0,0 +1,215 @@
+/*
+ * PackageLicenseDeclared: Apache-2.0
+ * Copyright (c) 2026 The mbed-js-st-fw-mqtt contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MBED_HTTP_CONNECTION_POOL_H_
+#define _MBED_HTTP_CONNECTION_POOL_H_
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+
+/* Number of connected sockets kept open between requests, 0 disables keep-alive */
+#ifndef HTTP_MAX_IDLE_CONNECTIONS
+#define HTTP_MAX_IDLE_CONNECTIONS 2
+#endif
+
+/* Idle sockets older than this are closed instead of reused */
+#ifndef HTTP_IDLE_TIMEOUT_MS
+#define HTTP_IDLE_TIMEOUT_MS 30000
+#endif
+
+struct http_pool_stats_t {
+    uint32_t reused;        // requests served on an idle connection
+    uint32_t connects;      // new connections
+    uint32_t stale;         // idle connections closed as expired or dropped by the server
+};
+
+/**
+ * \brief HttpConnectionPool keeps idle TCP connections per host:port, shared by all HttpRequest objects.
+ */
+class HttpConnectionPool {
+public:
+    /**
+     * Get a connected socket to host:port, an idle one if there is one.
+     *
+     * @param[in] network The network interface
+     * @param[in] host Host name
+     * @param[in] port Port
+     * @param[out] reused Set when the socket was an idle connection
+     * @param[out] error Error code when NULL is returned
+     * @return A connected TCPSocket, or NULL on failure
+     */
+    static TCPSocket* acquire(NetworkInterface* network, const char* host, uint16_t port,
+                              bool* reused, nsapi_error_t* error) {
+        State& s = state();
+        s.mutex.lock();
+
+        *reused = false;
+        for (size_t ix = 0; ix < POOL_SLOTS; ix++) {
+            Slot* slot = &s.slots[ix];
+            if (!slot->socket || slot->port != port || strcmp(slot->host, host) != 0) {
+                continue;
+            }
+
+            TCPSocket* socket = slot->socket;
+            uint32_t idle_ms = (us_ticker_read() - slot->idle_since) / 1000;
+            empty(slot);
+
+            if (idle_ms < HTTP_IDLE_TIMEOUT_MS && is_alive(socket)) {
+                s.stats.reused++;
+                s.mutex.unlock();
+                *reused = true;
+                return socket;
+            }
+
+            s.stats.stale++;
+            socket->close();
+            delete socket;
+        }
+
+        s.stats.connects++;
+        s.mutex.unlock();
+
+        // connect outside the lock, on the ESP8266 this is several AT round-trips
+        TCPSocket* socket = new TCPSocket();
+
+        nsapi_error_t r = socket->open(network);
+        if (r == 0) {
+            r = socket->connect(host, port);
+        }
+        if (r != 0) {
+            delete socket;
+            *error = r;
+            return NULL;
+        }
+
+        return socket;
+    }
+
+    /**
+     * Hand a socket from acquire() back.
+     *
+     * @param[in] socket The socket
+     * @param[in] host Host name it is connected to
+     * @param[in] port Port it is connected to
+     * @param[in] keep_alive Whether the connection can carry another request
+     */
+    static void release(TCPSocket* socket, const char* host, uint16_t port, bool keep_alive) {
+        State& s = state();
+
+        if (keep_alive && HTTP_MAX_IDLE_CONNECTIONS > 0) {
+            s.mutex.lock();
+
+            // park in a free slot, or in place of the connection idle the longest
+            Slot* slot = &s.slots[0];
+            uint32_t now = us_ticker_read();
+            for (size_t ix = 0; ix < POOL_SLOTS; ix++) {
+                if (!s.slots[ix].socket) {
+                    slot = &s.slots[ix];
+                    break;
+                }
+                if (now - s.slots[ix].idle_since > now - slot->idle_since) {
+                    slot = &s.slots[ix];
+                }
+            }
+
+            TCPSocket* evicted = slot->socket;
+            empty(slot);
+
+            slot->socket = socket;
+            slot->host = strdup(host);
+            slot->port = port;
+            slot->idle_since = now;
+
+            s.mutex.unlock();
+
+            if (!evicted) {
+                return;
+            }
+            socket = evicted;
+        }
+
+        socket->close();
+        delete socket;
+    }
+
+    /**
+     * Close all idle connections.
+     */
+    static void clear() {
+        State& s = state();
+        s.mutex.lock();
+        for (size_t ix = 0; ix < POOL_SLOTS; ix++) {
+            if (s.slots[ix].socket) {
+                s.slots[ix].socket->close();
+                delete s.slots[ix].socket;
+                empty(&s.slots[ix]);
+            }
+        }
+        s.mutex.unlock();
+    }
+
+    static http_pool_stats_t get_stats() {
+        return state().stats;
+    }
+
+private:
+    static const size_t POOL_SLOTS = HTTP_MAX_IDLE_CONNECTIONS > 0 ? HTTP_MAX_IDLE_CONNECTIONS : 1;
+
+    struct Slot {
+        TCPSocket* socket;
+        char* host;
+        uint16_t port;
+        uint32_t idle_since;
+    };
+
+    struct State {
+        State() {
+            memset(&stats, 0, sizeof(stats));
+            memset(slots, 0, sizeof(slots));
+        }
+
+        Mutex mutex;
+        Slot slots[POOL_SLOTS];
+        http_pool_stats_t stats;
+    };
+
+    // function local, so the header-only library has a single instance without a .cpp file
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static void empty(Slot* slot) {
+        free(slot->host);
+        slot->host = NULL;
+        slot->socket = NULL;
+    }
+
+    /**
+     * Peek at an idle socket. Nothing to read means the server still holds the connection,
+     * EOF or unexpected data means it has given up on it.
+     */
+    static bool is_alive(TCPSocket* socket) {
+        uint8_t b;
+        socket->set_blocking(false);
+        nsapi_size_or_error_t r = socket->recv(&b, 1);
+        socket->set_blocking(true);
+        return r == NSAPI_ERROR_WOULD_BLOCK;
+    }
+};
+
+#endif // _MBED_HTTP_CONNECTION_POOL_H_
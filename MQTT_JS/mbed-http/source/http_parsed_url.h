@@ -20,74 +20,95 @@
 
 #include "http_parser.h"
 
+/**
+ * \brief ParsedUrl splits a URL into its parts.
+ *
+ * The parts are copied NUL-terminated into one buffer, so parsing a URL is a single allocation,
+ * and their lengths are kept so building a request needs no strlen.
+ */
 class ParsedUrl {
 public:
     ParsedUrl(const char* url) {
         struct http_parser_url parsed_url;
-        http_parser_parse_url(url, strlen(url), false, &parsed_url);
-
-        for (size_t ix = 0; ix < UF_MAX; ix++) {
-            char* value;
-            if (parsed_url.field_set & (1 << ix)) {
-                value = (char*)calloc(parsed_url.field_data[ix].len + 1, 1);
-                memcpy((void*)value, url + parsed_url.field_data[ix].off,
-                       parsed_url.field_data[ix].len);
+        size_t url_len = strlen(url);
+        if (http_parser_parse_url(url, url_len, false, &parsed_url) != 0) {
+            memset(&parsed_url, 0, sizeof(parsed_url));
+        }
+
+        // every part NUL-terminated, plus room for a default path of "/"
+        _buffer = (char*)malloc(url_len + PART_COUNT + 1);
+
+        size_t offset = 0;
+        for (size_t ix = 0; ix < PART_COUNT; ix++) {
+            http_parser_url_fields field = part_field(ix);
+            size_t len = 0;
+            if (parsed_url.field_set & (1 << field)) {
+                len = parsed_url.field_data[field].len;
+                memcpy(_buffer + offset, url + parsed_url.field_data[field].off, len);
             }
-            else {
-                value = (char*)calloc(1, 1);
+            else if (field == UF_PATH) {
+                len = 1;
+                _buffer[offset] = '/';
             }
+            _buffer[offset + len] = 0;
 
-            switch ((http_parser_url_fields)ix) {
-                case UF_SCHEMA:   _schema   = value; break;
-                case UF_HOST:     _host     = value; break;
-                case UF_PATH:     _path     = value; break;
-                case UF_QUERY:    _query    = value; break;
-                case UF_USERINFO: _userinfo = value; break;
-                default:
-                    // PORT is already parsed, FRAGMENT is not relevant for HTTP requests
-                    free((void*)value);
-                    break;
-            }
+            _parts[ix].offset = offset;
+            _parts[ix].length = len;
+            offset += len + 1;
         }
 
         _port = parsed_url.port;
         if (!_port) {
-            if (strcmp(_schema, "https") == 0) {
+            if (strcmp(schema(), "https") == 0) {
                 _port = 443;
             }
             else {
                 _port = 80;
             }
         }
-
-        if (strcmp(_path, "") == 0) {
-            _path = (char*)calloc(2, 1);
-            _path[0] = '/';
-        }
     }
 
     ~ParsedUrl() {
-        if (_schema) free((void*)_schema);
-        if (_host) free((void*)_host);
-        if (_path) free((void*)_path);
-        if (_query) free((void*)_query);
-        if (_userinfo) free((void*)_userinfo);
+        free(_buffer);
     }
 
     uint16_t port() const { return _port; }
-    char* schema() const { return _schema; }
-    char* host() const { return _host; }
-    char* path() const { return _path; }
-    char* query() const { return _query; }
-    char* userinfo() const { return _userinfo; }
+    char* schema() const { return part(SCHEMA); }
+    char* host() const { return part(HOST); }
+    char* path() const { return part(PATH); }
+    char* query() const { return part(QUERY); }
+    char* userinfo() const { return part(USERINFO); }
+
+    size_t host_length() const { return _parts[HOST].length; }
+    size_t path_length() const { return _parts[PATH].length; }
+    size_t query_length() const { return _parts[QUERY].length; }
 
 private:
+    // FRAGMENT is not relevant for HTTP requests, PORT is kept as a number
+    enum { SCHEMA, HOST, PATH, QUERY, USERINFO, PART_COUNT };
+
+    struct part_t {
+        size_t offset;
+        size_t length;
+    };
+
+    char* part(int ix) const {
+        return _buffer + _parts[ix].offset;
+    }
+
+    static http_parser_url_fields part_field(size_t ix) {
+        switch (ix) {
+            case SCHEMA:   return UF_SCHEMA;
+            case HOST:     return UF_HOST;
+            case PATH:     return UF_PATH;
+            case QUERY:    return UF_QUERY;
+            default:       return UF_USERINFO;
+        }
+    }
+
     uint16_t _port;
-    char* _schema;
-    char* _host;
-    char* _path;
-    char* _query;
-    char* _userinfo;
+    char* _buffer;
+    part_t _parts[PART_COUNT];
 };
 
 #endif // _MBED_HTTP_PARSED_URL_H_
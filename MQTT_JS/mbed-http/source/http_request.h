@@ -26,6 +26,7 @@
 #include "http_request_builder.h"
 #include "http_request_parser.h"
 #include "http_parsed_url.h"
+#include "http_connection_pool.h"
 
 /**
  * @todo:
@@ -40,6 +41,8 @@ class HttpRequest {
 public:
     /**
      * HttpRequest Constructor
+     * The connection is taken from the HttpConnectionPool on send(), so requests to the same host:port
+     * reuse connections the server kept alive.
      *
      * @param[in] aNetwork The network interface
      * @param[in] aMethod HTTP method to use
@@ -53,11 +56,15 @@ public:
     {
         error = 0;
         response = NULL;
+        body_buffer = NULL;
+        body_buffer_size = 0;
+        max_body = 0;
+        repeatable = false;
 
         parsed_url = new ParsedUrl(url);
         request_builder = new HttpRequestBuilder(method, parsed_url);
 
-        socket = new TCPSocket();
+        socket = NULL;
         we_created_socket = true;
     }
 
@@ -76,6 +83,10 @@ public:
     {
         error = 0;
         response = NULL;
+        body_buffer = NULL;
+        body_buffer_size = 0;
+        max_body = 0;
+        repeatable = false;
         network = NULL;
 
         parsed_url = new ParsedUrl(url);
@@ -94,24 +105,107 @@ public:
             delete response;
         }
 
-        if (parsed_url) {
-            delete parsed_url;
+        // before parsed_url goes, the pool finds the connection by its host
+        if (socket && we_created_socket) {
+            HttpConnectionPool::release(socket, parsed_url->host(), parsed_url->port(), false);
         }
 
         if (request_builder) {
             delete request_builder;
         }
 
-        if (socket && we_created_socket) {
-            delete socket;
+        if (parsed_url) {
+            delete parsed_url;
         }
     }
 
     /**
      * Execute the request and receive the response.
+     * A second send() fails with error -2100, unless set_repeatable() was called.
      */
     HttpResponse* send(const void* body = NULL, nsapi_size_t body_size = 0) {
-        if (response != NULL) {
+        size_t request_size = 0;
+        char* request = request_builder->build(body, body_size, request_size);
+
+        HttpResponse* res = execute(request, request_size, 0, 0);
+
+        free(request);
+        return res;
+    }
+
+    /**
+     * Execute the request with a body that is pulled from a callback while it is sent, and receive the response.
+     * Only the headers and one chunk of HTTP_SEND_CHUNK_SIZE bytes are held in RAM.
+     *
+     * @param[in] body_source Callback that fills at most size bytes of buffer with the next part of the body,
+     *                        and returns the number of bytes filled, 0 at the end of the body
+     * @param[in] body_size Length of the body, or -1 if it is not known up front. The body is then sent
+     *                      with 'Transfer-Encoding: chunked'.
+     */
+    HttpResponse* send_stream(Callback<size_t(char* buffer, size_t size)> body_source, int body_size = -1) {
+        size_t head_size = 0;
+        char* head = request_builder->build_head(body_size, head_size);
+
+        HttpResponse* res = execute(head, head_size, body_source, body_size);
+
+        free(head);
+        return res;
+    }
+
+    /**
+     * Set a header for the request.
+     *
+     * The 'Host' and 'Content-Length' headers are set automatically.
+     * Setting the same header twice will overwrite the previous entry.
+     *
+     * @param[in] key Header key
+     * @param[in] value Header value
+     */
+    void set_header(string key, string value) {
+        request_builder->set_header(key, value);
+    }
+
+    /**
+     * Collect the response body in buffer instead of on the heap.
+     * A larger body fails the request with error -2103.
+     *
+     * @param[in] buffer Buffer, must stay valid as long as the response
+     * @param[in] size Size of buffer
+     */
+    void set_body_buffer(void* buffer, size_t size) {
+        body_buffer = buffer;
+        body_buffer_size = size;
+    }
+
+    /**
+     * Fail the request with error -2103 when the response body is larger than max_body bytes.
+     * 0, the default, is no limit.
+     */
+    void set_max_body(size_t a_max_body) {
+        max_body = a_max_body;
+    }
+
+    /**
+     * Allow send() to be called again to repeat the request, for example to poll an endpoint.
+     * Each send() then deletes the HttpResponse of the previous one, do not hold on to it.
+     */
+    void set_repeatable(bool a_repeatable) {
+        repeatable = a_repeatable;
+    }
+
+    /**
+     * Get the error code.
+     *
+     * When send() fails, this error is set.
+     */
+    nsapi_error_t get_error() {
+        return error;
+    }
+
+private:
+    HttpResponse* execute(const char* request, size_t request_size,
+                          Callback<size_t(char* buffer, size_t size)> body_source, int body_size) {
+        if (response != NULL && !repeatable) {
             // already executed this response
             error = -2100; // @todo, make a lookup table with errors
             return NULL;
@@ -119,34 +213,83 @@ public:
 
         error = 0;
 
+        bool reused = false;
+
         if (we_created_socket) {
-            nsapi_error_t open_result = socket->open(network);
-            if (open_result != 0) {
-                error = open_result;
+            socket = HttpConnectionPool::acquire(network, parsed_url->host(), parsed_url->port(), &reused, &error);
+            if (!socket) {
                 return NULL;
             }
+        }
 
-            nsapi_error_t connection_result = socket->connect(parsed_url->host(), parsed_url->port());
-            if (connection_result != 0) {
-                error = connection_result;
-                return NULL;
+        bool committed = false;
+        nsapi_size_or_error_t ret = exchange(request, request_size, body_source, body_size, committed);
+
+        if (ret < 0 && reused && !committed) {
+            // the server dropped the idle connection while it was pooled, try once more on a fresh one
+            HttpConnectionPool::release(socket, parsed_url->host(), parsed_url->port(), false);
+            socket = HttpConnectionPool::acquire(network, parsed_url->host(), parsed_url->port(), &reused, &error);
+            if (socket) {
+                ret = exchange(request, request_size, body_source, body_size, committed);
             }
         }
 
-        size_t request_size = 0;
-        char* request = request_builder->build(body, body_size, request_size);
+        if (we_created_socket && socket) {
+            // hand the socket back, the pool keeps it open if the server does
+            HttpConnectionPool::release(socket, parsed_url->host(), parsed_url->port(),
+                                        ret > 0 && response->is_keep_alive());
+            socket = NULL;
+        }
 
-        nsapi_size_or_error_t send_result = socket->send(request, request_size);
+        if (ret < 0) {
+            return NULL;
+        }
 
-        free(request);
+        return response;
+    }
 
-        if (send_result != request_size) {
+    /**
+     * Send the request and read the response into response.
+     *
+     * @param[out] committed Set once the request cannot be replayed: response data was read,
+     *                       the body source was called, or a non-idempotent request was sent
+     * @return The last recv() result, > 0 when the message completed before the server closed
+     *         the connection, or < 0 on failure (error is set), also when the connection
+     *         closed before the message was complete
+     */
+    nsapi_size_or_error_t exchange(const char* request, size_t request_size,
+                                   Callback<size_t(char* buffer, size_t size)> body_source, int body_size,
+                                   bool& committed) {
+        nsapi_size_or_error_t send_result = send_all(request, request_size);
+
+        if (send_result < 0) {
             error = send_result;
-            return NULL;
+            return error;
+        }
+
+        if (body_source) {
+            send_result = HttpRequestBuilder::stream_body(callback(this, &HttpRequest::send_all),
+                                                          body_source, body_size, committed);
+            if (send_result < 0) {
+                error = send_result;
+                return error;
+            }
+        }
+
+        // the server may act on it even if the response never comes (RFC 7230 6.3.1)
+        if (!request_builder->is_idempotent()) {
+            committed = true;
         }
 
         // Create a response object
+        if (response) {
+            delete response;
+        }
         response = new HttpResponse();
+        if (body_buffer) {
+            response->set_body_buffer(body_buffer, body_buffer_size);
+        }
+        response->set_max_body(max_body);
         // And a response parser
         HttpParser parser(response, HTTP_RESPONSE, body_callback);
 
@@ -156,14 +299,16 @@ public:
         // TCPSocket::recv is called until we don't have any data anymore
         nsapi_size_or_error_t recv_ret;
         while ((recv_ret = socket->recv(recv_buffer, HTTP_RECEIVE_BUFFER_SIZE)) > 0) {
+            committed = true;
 
             // Pass the chunk into the http_parser
             size_t nparsed = parser.execute((const char*)recv_buffer, recv_ret);
             if (nparsed != recv_ret) {
                 // printf("Parsing failed... parsed %d bytes, received %d bytes\n", nparsed, recv_ret);
-                error = -2101;
+                error = response->is_header_overflow() ? NSAPI_ERROR_NO_MEMORY :
+                        response->is_body_overflow() ? -2103 : -2101;
                 free(recv_buffer);
-                return NULL;
+                return error;
             }
 
             if (response->is_message_complete()) {
@@ -174,7 +319,7 @@ public:
         if (recv_ret < 0) {
             error = recv_ret;
             free(recv_buffer);
-            return NULL;
+            return error;
         }
 
         // When done, call parser.finish()
@@ -183,41 +328,39 @@ public:
         // Free the receive buffer
         free(recv_buffer);
 
-        if (we_created_socket) {
-            // Close the socket
-            socket->close();
+        if (!response->is_message_complete()) {
+            // closed before the whole response came, e.g. a pooled connection the server dropped
+            error = NSAPI_ERROR_CONNECTION_LOST;
+            return error;
         }
 
-        return response;
-    }
-
-    /**
-     * Set a header for the request.
-     *
-     * The 'Host' and 'Content-Length' headers are set automatically.
-     * Setting the same header twice will overwrite the previous entry.
-     *
-     * @param[in] key Header key
-     * @param[in] value Header value
-     */
-    void set_header(string key, string value) {
-        request_builder->set_header(key, value);
+        return recv_ret;
     }
 
     /**
-     * Get the error code.
-     *
-     * When send() fails, this error is set.
+     * TCPSocket::send may take less than all of it, keep going until it has.
      */
-    nsapi_error_t get_error() {
-        return error;
+    nsapi_size_or_error_t send_all(const void* data, size_t size) {
+        const char* p = (const char*)data;
+        while (size > 0) {
+            nsapi_size_or_error_t r = socket->send(p, size);
+            if (r < 0) {
+                return r;
+            }
+            p += r;
+            size -= r;
+        }
+        return 0;
     }
 
-private:
     NetworkInterface* network;
     TCPSocket* socket;
     http_method method;
     Callback<void(const char *at, size_t length)> body_callback;
+    void* body_buffer;
+    size_t body_buffer_size;
+    size_t max_body;
+    bool repeatable;
 
     ParsedUrl* parsed_url;
 
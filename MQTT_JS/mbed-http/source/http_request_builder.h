@@ -23,86 +23,88 @@
 #include "http_parser.h"
 #include "http_parsed_url.h"
 
+#ifndef HTTP_SEND_CHUNK_SIZE
+#define HTTP_SEND_CHUNK_SIZE 512
+#endif
+
+/**
+ * \brief HttpRequestBuilder renders requests for a method and URL.
+ *
+ * The request line and headers are rendered once into a block, and only rendered again after set_header().
+ * Building a request copies the block and adds the body framing (Content-Length or Transfer-Encoding).
+ */
 class HttpRequestBuilder {
 public:
     HttpRequestBuilder(http_method a_method, ParsedUrl* a_parsed_url)
         : method(a_method), parsed_url(a_parsed_url)
     {
+        method_str = http_method_str(method);
+        method_len = strlen(method_str);
+
+        head_block = NULL;
+        head_block_len = 0;
+        head_block_dirty = true;
+
         set_header("Host", string(parsed_url->host()));
     }
 
+    ~HttpRequestBuilder() {
+        free(head_block);
+    }
+
+    /**
+     * Whether sending the request twice has the same effect as sending it once (RFC 7231 4.2.2),
+     * so it can be replayed on a fresh connection when a pooled one turns out to be dead.
+     */
+    bool is_idempotent() const {
+        return method == HTTP_GET || method == HTTP_HEAD || method == HTTP_OPTIONS ||
+               method == HTTP_PUT || method == HTTP_DELETE || method == HTTP_TRACE;
+    }
+
     /**
      * Set a header for the request
      * If the key already exists, it will be overwritten...
+     * Content-Length and Transfer-Encoding follow from the body and are ignored here.
      */
     void set_header(string key, string value) {
         map<string, string>::iterator it = headers.find(key);
 
         if (it != headers.end()) {
+            if (it->second == value) {
+                return;
+            }
             it->second = value;
         }
         else {
             headers.insert(headers.end(), pair<string, string>(key, value));
         }
+
+        head_block_dirty = true;
     }
 
     char* build(const void* body, size_t body_size, size_t &size) {
-        const char* method_str = http_method_str(method);
-
+        int body_length = BODY_NONE;
         if (method == HTTP_POST || method == HTTP_PUT || method == HTTP_DELETE || body_size > 0) {
-            char buffer[10];
-            snprintf(buffer, 10, "%d", body_size);
-            set_header("Content-Length", string(buffer));
+            body_length = body_size;
         }
 
-        size = 0;
+        size_t head_size = head_length(body_length);
 
-        // first line is METHOD PATH+QUERY HTTP/1.1\r\n
-        size += strlen(method_str) + 1 + strlen(parsed_url->path()) + (strlen(parsed_url->query()) ? strlen(parsed_url->query()) + 1 : 0) + 1 + 8 + 2;
-
-        // after that we'll do the headers
-        typedef map<string, string>::iterator it_type;
-        for(it_type it = headers.begin(); it != headers.end(); it++) {
-            // line is KEY: VALUE\r\n
-            size += it->first.length() + 1 + 1 + it->second.length() + 2;
-        }
-
-        // then the body, first an extra newline
-        size += 2;
-
-        // body
-        size += body_size;
-
-        // extra newline
-        size += 2;
+        // head, the body, and an extra newline
+        size = head_size + body_size + 2;
 
         // Now let's print it
-        char* req = (char*)calloc(size + 1, 1);
+        char* req = (char*)malloc(size + 1);
         char* originalReq = req;
 
-        if (strlen(parsed_url->query())) {
-            sprintf(req, "%s %s?%s HTTP/1.1\r\n", method_str, parsed_url->path(), parsed_url->query());
-        } else {
-            sprintf(req, "%s %s%s HTTP/1.1\r\n", method_str, parsed_url->path(), parsed_url->query());
-        }
-        req += strlen(method_str) + 1 + strlen(parsed_url->path()) + (strlen(parsed_url->query()) ? strlen(parsed_url->query()) + 1 : 0) + 1 + 8 + 2;
-
-        typedef map<string, string>::iterator it_type;
-        for(it_type it = headers.begin(); it != headers.end(); it++) {
-            // line is KEY: VALUE\r\n
-            sprintf(req, "%s: %s\r\n", it->first.c_str(), it->second.c_str());
-            req += it->first.length() + 1 + 1 + it->second.length() + 2;
-        }
-
-        sprintf(req, "\r\n");
-        req += 2;
+        req += write_head(req, body_length);
 
         if (body_size > 0) {
             memcpy(req, body, body_size);
         }
         req += body_size;
 
-        sprintf(req, "\r\n");
+        memcpy(req, "\r\n", 3);
         req += 2;
 
         // Uncomment to debug...
@@ -113,10 +115,218 @@ public:
         return originalReq;
     }
 
+    /**
+     * Build the request line and headers only, for a body that is sent with stream_body().
+     *
+     * @param[in] body_size Length of the body, or -1 when it is not known up front and is sent chunked
+     * @param[out] size Length of the head
+     */
+    char* build_head(int body_size, size_t &size) {
+        int body_length = body_size < 0 ? BODY_CHUNKED : body_size;
+
+        size = head_length(body_length);
+
+        char* req = (char*)malloc(size + 1);
+        req[write_head(req, body_length)] = 0;
+        return req;
+    }
+
+    /**
+     * Pull a body from source and write it to sink, chunked when body_size is -1.
+     *
+     * Only one chunk buffer of HTTP_SEND_CHUNK_SIZE bytes is allocated, whatever the length of the body.
+     *
+     * @param[in] sink Writes all given bytes, returns the number written or a negative error
+     * @param[in] source Fills at most size bytes of buffer, returns the number filled, 0 at the end of the body
+     * @param[in] body_size Length of the body, or -1 for chunked transfer encoding
+     * @param[out] pulled Set once source has been called, the body cannot be sent again after that
+     * @return 0 on success, or a negative error
+     */
+    static nsapi_size_or_error_t stream_body(Callback<nsapi_size_or_error_t(const void* data, size_t size)> sink,
+                                             Callback<size_t(char* buffer, size_t size)> source,
+                                             int body_size, bool& pulled) {
+        // room for the chunk size line in front and the CRLF behind the data
+        const size_t chunk_head = 6;
+        char* buffer = (char*)malloc(chunk_head + HTTP_SEND_CHUNK_SIZE + 2);
+        if (!buffer) {
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+
+        char* data = buffer + chunk_head;
+        size_t remaining = body_size < 0 ? 0 : (size_t)body_size;
+        nsapi_size_or_error_t ret = 0;
+
+        while (body_size < 0 || remaining > 0) {
+            size_t want = HTTP_SEND_CHUNK_SIZE;
+            if (body_size >= 0 && remaining < want) {
+                want = remaining;
+            }
+
+            pulled = true;
+            size_t n = source(data, want);
+            if (n > want) {
+                n = want;
+            }
+
+            if (body_size >= 0) {
+                if (n == 0) {
+                    // the source ran dry before Content-Length bytes
+                    ret = -2102;
+                    break;
+                }
+                remaining -= n;
+                ret = sink(data, n);
+            }
+            else {
+                // "<hex size>\r\n<data>\r\n", the last chunk is empty
+                char line[chunk_head + 1];
+                int line_len = snprintf(line, sizeof(line), "%x\r\n", (unsigned int)n);
+                memcpy(data - line_len, line, line_len);
+                memcpy(data + n, "\r\n", 2);
+                ret = sink(data - line_len, line_len + n + 2);
+            }
+
+            if (ret < 0 || (body_size < 0 && n == 0)) {
+                break;
+            }
+        }
+
+        free(buffer);
+        return ret < 0 ? ret : 0;
+    }
+
 private:
+    // body_length values besides a Content-Length
+    enum { BODY_CHUNKED = -1, BODY_NONE = -2 };
+
+    static bool is_framing_header(const string& key) {
+        return strcicmp(key.c_str(), "content-length") == 0 || strcicmp(key.c_str(), "transfer-encoding") == 0;
+    }
+
+    /**
+     * Render the request line and headers into head_block
+     */
+    void render_head() {
+        // first line is METHOD PATH?QUERY HTTP/1.1\r\n
+        size_t size = method_len + 1 + parsed_url->path_length() +
+                      (parsed_url->query_length() ? parsed_url->query_length() + 1 : 0) + 11;
+
+        // after that we'll do the headers
+        typedef map<string, string>::iterator it_type;
+        for(it_type it = headers.begin(); it != headers.end(); it++) {
+            if (!is_framing_header(it->first)) {
+                // line is KEY: VALUE\r\n
+                size += it->first.length() + 1 + 1 + it->second.length() + 2;
+            }
+        }
+
+        free(head_block);
+        head_block = (char*)malloc(size);
+        head_block_len = size;
+        head_block_dirty = false;
+
+        char* req = head_block;
+        memcpy(req, method_str, method_len);
+        req += method_len;
+        *req++ = ' ';
+        memcpy(req, parsed_url->path(), parsed_url->path_length());
+        req += parsed_url->path_length();
+        if (parsed_url->query_length()) {
+            *req++ = '?';
+            memcpy(req, parsed_url->query(), parsed_url->query_length());
+            req += parsed_url->query_length();
+        }
+        memcpy(req, " HTTP/1.1\r\n", 11);
+        req += 11;
+
+        for(it_type it = headers.begin(); it != headers.end(); it++) {
+            if (!is_framing_header(it->first)) {
+                memcpy(req, it->first.data(), it->first.length());
+                req += it->first.length();
+                *req++ = ':';
+                *req++ = ' ';
+                memcpy(req, it->second.data(), it->second.length());
+                req += it->second.length();
+                *req++ = '\r';
+                *req++ = '\n';
+            }
+        }
+    }
+
+    size_t head_length(int body_length) {
+        if (head_block_dirty) {
+            render_head();
+        }
+
+        size_t size = head_block_len;
+        if (body_length >= 0) {
+            size += 16 + decimal_length(body_length) + 2;     // Content-Length: N\r\n
+        }
+        else if (body_length == BODY_CHUNKED) {
+            size += 28;                                         // Transfer-Encoding: chunked\r\n
+        }
+
+        // then an extra newline
+        return size + 2;
+    }
+
+    size_t write_head(char* req, int body_length) {
+        char* originalReq = req;
+
+        memcpy(req, head_block, head_block_len);
+        req += head_block_len;
+
+        if (body_length >= 0) {
+            memcpy(req, "Content-Length: ", 16);
+            req += 16;
+            size_t digits = decimal_length(body_length);
+            for (size_t ix = digits; ix > 0; ix--) {
+                req[ix - 1] = '0' + body_length % 10;
+                body_length /= 10;
+            }
+            req += digits;
+            *req++ = '\r';
+            *req++ = '\n';
+        }
+        else if (body_length == BODY_CHUNKED) {
+            memcpy(req, "Transfer-Encoding: chunked\r\n", 28);
+            req += 28;
+        }
+
+        *req++ = '\r';
+        *req++ = '\n';
+
+        return req - originalReq;
+    }
+
+    static size_t decimal_length(int value) {
+        size_t digits = 1;
+        while (value >= 10) {
+            value /= 10;
+            digits++;
+        }
+        return digits;
+    }
+
+    // from http://stackoverflow.com/questions/5820810/case-insensitive-string-comp-in-c
+    static int strcicmp(char const *a, char const *b) {
+        for (;; a++, b++) {
+            int d = tolower(*a) - tolower(*b);
+            if (d != 0 || !*a) {
+                return d;
+            }
+        }
+    }
+
     http_method method;
+    const char* method_str;
+    size_t method_len;
     ParsedUrl* parsed_url;
     map<string, string> headers;
+
+    char* head_block;
+    size_t head_block_len;
+    bool head_block_dirty;
 };
 
 #endif // _MBED_HTTP_REQUEST_BUILDER_H_
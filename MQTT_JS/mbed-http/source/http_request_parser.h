@@ -81,21 +81,22 @@ private:
         return 0;
     }
 
+    // a non-zero return stops the parser, the headers are out of memory
     int on_header_field(http_parser* parser, const char *at, size_t length) {
-        string s(at, length);
-        response->set_header_field(s);
-        return 0;
+        return response->set_header_field(at, length) ? 0 : 1;
     }
 
     int on_header_value(http_parser* parser, const char *at, size_t length) {
-        string s(at, length);
-        response->set_header_value(s);
-        return 0;
+        return response->set_header_value(at, length) ? 0 : 1;
     }
 
     int on_headers_complete(http_parser* parser) {
-        response->set_headers_complete();
+        if (!response->set_headers_complete()) {
+            return -1;  // 1 and 2 mean no body and upgrade here
+        }
         response->set_method((http_method)parser->method);
+        // false for HTTP/1.0 without keep-alive, 'Connection: close' or a body delimited by EOF
+        response->set_keep_alive(http_should_keep_alive(parser) != 0);
         return 0;
     }
 
@@ -107,8 +108,8 @@ private:
             return 0;
         }
 
-        response->set_body(at, length);
-        return 0;
+        // a non-zero return stops the parser, the body is over its limit
+        return response->set_body(at, length) ? 0 : 1;
     }
 
     int on_message_complete(http_parser* parser) {
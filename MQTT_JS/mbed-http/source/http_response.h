@@ -23,25 +23,48 @@
 
 using namespace std;
 
+/* First size of a body of unknown length, it doubles when full */
+#ifndef HTTP_BODY_INITIAL_SIZE
+#define HTTP_BODY_INITIAL_SIZE 512
+#endif
+
+/* First size of the header arena, it doubles when full */
+#ifndef HTTP_HEADER_ARENA_SIZE
+#define HTTP_HEADER_ARENA_SIZE 256
+#endif
+
 class HttpResponse {
 public:
     HttpResponse() {
         status_code = 0;
         concat_header_field = false;
         concat_header_value = false;
+        header_arena = NULL;
+        header_arena_size = 0;
+        header_arena_used = 0;
+        header_overflow = false;
+        content_type_ix = -1;
+        transfer_encoding_ix = -1;
         expected_content_length = 0;
         is_chunked = false;
         is_message_completed = false;
+        keep_alive = false;
         body_length = 0;
         body_offset = 0;
+        body_capacity = 0;
+        body_max = 0;
+        body_owned = true;
+        body_overflow = false;
         body = NULL;
     }
 
     ~HttpResponse() {
-        if (body != NULL) {
+        if (body != NULL && body_owned) {
             free(body);
         }
 
+        free(header_arena);
+
         for (size_t ix = 0; ix < header_fields.size(); ix++) {
             delete header_fields[ix];
             delete header_values[ix];
@@ -77,84 +100,206 @@ public:
         return method;
     }
 
-    void set_header_field(string field) {
-        concat_header_value = false;
+    /**
+     * Append (part of) a header name. http_parser can split a name over several callbacks,
+     * the parts are appended in place.
+     *
+     * @return false when the headers do not fit in memory, see is_header_overflow()
+     */
+    bool set_header_field(const char *at, size_t length) {
+        if (header_overflow) {
+            return false;
+        }
+
+        if (!concat_header_field) {
+            // a new header starts, terminate the previous value
+            if (concat_header_value) {
+                end_header_value();
+            }
 
-        // headers can be chunked
-        if (concat_header_field) {
-            *header_fields[header_fields.size() - 1] = (*header_fields[header_fields.size() - 1]) + field;
+            header_t header;
+            header.field = header_arena_used;
+            header.value = NO_VALUE;
+            headers.push_back(header);
         }
-        else {
-            header_fields.push_back(new string(field));
+
+        if (!append_header(at, length)) {
+            return false;
         }
 
+        concat_header_value = false;
         concat_header_field = true;
+        return true;
     }
 
-    void set_header_value(string value) {
+    /**
+     * Append (part of) a header value.
+     *
+     * @return false when the headers do not fit in memory
+     */
+    bool set_header_value(const char *at, size_t length) {
+        if (header_overflow) {
+            return false;
+        }
+
+        if (!concat_header_value) {
+            if (concat_header_field) {
+                end_header_field();
+            }
+            headers[headers.size() - 1].value = header_arena_used;
+        }
+
+        if (!append_header(at, length)) {
+            return false;
+        }
+
         concat_header_field = false;
+        concat_header_value = true;
+        return true;
+    }
+
+    bool set_headers_complete() {
+        if (header_overflow) {
+            return false;
+        }
 
-        // headers can be chunked
         if (concat_header_value) {
-            *header_values[header_values.size() - 1] = (*header_values[header_values.size() - 1]) + value;
+            end_header_value();
         }
-        else {
-            header_values.push_back(new string(value));
+        else if (concat_header_field) {
+            end_header_field();
         }
+        concat_header_field = false;
+        concat_header_value = false;
+        return true;
+    }
 
-        concat_header_value = true;
+    size_t get_headers_length() {
+        return headers.size();
     }
 
-    void set_headers_complete() {
-        for (size_t ix = 0; ix < header_fields.size(); ix++) {
-            if (strcicmp(header_fields[ix]->c_str(), "content-length") == 0) {
-                expected_content_length = (size_t)atoi(header_values[ix]->c_str());
-                break;
+    /**
+     * Name of header ix, valid as long as the response
+     */
+    const char* get_header_field(size_t ix) {
+        return header_arena + headers[ix].field;
+    }
+
+    /**
+     * Value of header ix, valid as long as the response
+     */
+    const char* get_header_value(size_t ix) {
+        if (headers[ix].value == NO_VALUE) {
+            return "";
+        }
+        return header_arena + headers[ix].value;
+    }
+
+    /**
+     * Value of the first header named key (case insensitive), or NULL
+     */
+    const char* get_header(const char* key) {
+        for (size_t ix = 0; ix < headers.size(); ix++) {
+            if (strcicmp(get_header_field(ix), key) == 0) {
+                return get_header_value(ix);
             }
         }
+        return NULL;
     }
 
-    size_t get_headers_length() {
-        return header_fields.size();
+    /**
+     * Value of the Content-Type header, or NULL
+     */
+    const char* get_content_type() {
+        return content_type_ix < 0 ? NULL : get_header_value(content_type_ix);
     }
 
+    /**
+     * Value of the Transfer-Encoding header, or NULL
+     */
+    const char* get_transfer_encoding() {
+        return transfer_encoding_ix < 0 ? NULL : get_header_value(transfer_encoding_ix);
+    }
+
+    /**
+     * Copies of the header names, kept for existing callers. Prefer get_header_field(),
+     * which does not allocate.
+     */
     vector<string*> get_headers_fields() {
+        copy_headers();
         return header_fields;
     }
 
+    /**
+     * Copies of the header values, see get_headers_fields().
+     */
     vector<string*> get_headers_values() {
+        copy_headers();
         return header_values;
     }
 
-    void set_body(const char *at, size_t length) {
+    /**
+     * Collect the body in buffer instead of on the heap. A body larger than size fails the request.
+     * Must be set before the body arrives.
+     */
+    void set_body_buffer(void* buffer, size_t size) {
+        body = (char*)buffer;
+        body_capacity = size;
+        body_max = size;
+        body_owned = false;
+    }
+
+    /**
+     * Fail the request when the body is larger than max_body bytes, 0 for no limit.
+     */
+    void set_max_body(size_t max_body) {
+        if (body_owned) {
+            body_max = max_body;
+        }
+    }
+
+    /**
+     * Whether the body did not fit in the buffer or exceeded the maximum.
+     */
+    bool is_body_overflow() {
+        return body_overflow;
+    }
+
+    /**
+     * Whether the headers could not be stored, the request fails with NSAPI_ERROR_NO_MEMORY.
+     * No headers are kept then.
+     */
+    bool is_header_overflow() {
+        return header_overflow;
+    }
+
+    /**
+     * Append a part of the body.
+     *
+     * @return false when it does not fit, the rest of the body is dropped
+     */
+    bool set_body(const char *at, size_t length) {
         // Connection: close, could not specify Content-Length, nor chunked... So do it like this:
         if (expected_content_length == 0 && length > 0) {
             is_chunked = true;
         }
 
-        // only malloc when this fn is called, so we don't alloc when body callback's are enabled
-        if (body == NULL && !is_chunked) {
-            body = (char*)malloc(expected_content_length);
+        if (body_overflow) {
+            return false;
         }
 
-        if (is_chunked) {
-            if (body == NULL) {
-                body = (char*)malloc(length);
-            }
-            else {
-                char* original_body = body;
-                body = (char*)realloc(body, body_offset + length);
-                if (body == NULL) {
-                    printf("[HttpResponse] realloc for %d bytes failed\n", body_offset + length);
-                    free(original_body);
-                    return;
-                }
+        if (body_offset + length > body_capacity) {
+            // only malloc when this fn is called, so we don't alloc when body callback's are enabled
+            if (!grow_body(body_offset + length)) {
+                body_overflow = true;
+                return false;
             }
         }
 
         memcpy(body + body_offset, at, length);
 
         body_offset += length;
+        return true;
     }
 
     void* get_body() {
@@ -184,9 +329,131 @@ public:
 
     void set_message_complete() {
         is_message_completed = true;
+
+        // give back what doubling reserved beyond the end of the body
+        if (body_owned && body != NULL && body_capacity > body_offset && body_offset > 0) {
+            char* shrunk = (char*)realloc(body, body_offset);
+            if (shrunk != NULL) {
+                body = shrunk;
+                body_capacity = body_offset;
+            }
+        }
+    }
+
+    void set_keep_alive(bool a_keep_alive) {
+        keep_alive = a_keep_alive;
+    }
+
+    /**
+     * Whether the server will keep the connection open after this response.
+     */
+    bool is_keep_alive() {
+        return keep_alive;
     }
 
 private:
+    /**
+     * Names and values are stored NUL-terminated one after the other in header_arena,
+     * a header keeps the offsets of its name and value.
+     */
+    struct header_t {
+        size_t field;
+        size_t value;
+    };
+
+    static const size_t NO_VALUE = (size_t)-1;
+
+    /**
+     * Make room for at least needed bytes of body. A known Content-Length is allocated in one go,
+     * otherwise the capacity doubles, so a body of n bytes takes O(log n) reallocs and O(n) copying.
+     */
+    bool grow_body(size_t needed) {
+        if (!body_owned || (body_max && needed > body_max)) {
+            return false;
+        }
+
+        size_t size;
+        if (!is_chunked && expected_content_length >= needed) {
+            size = expected_content_length;
+        }
+        else {
+            size = body_capacity ? body_capacity * 2 : HTTP_BODY_INITIAL_SIZE;
+            while (size < needed) {
+                size *= 2;
+            }
+        }
+        if (body_max && size > body_max) {
+            size = body_max;
+        }
+
+        char* grown = (char*)realloc(body, size);
+        if (grown == NULL) {
+            printf("[HttpResponse] realloc for %d bytes failed\n", size);
+            return false;
+        }
+        body = grown;
+        body_capacity = size;
+        return true;
+    }
+
+    bool append_header(const char *at, size_t length) {
+        // one spare byte for the terminator
+        if (header_arena_used + length + 1 > header_arena_size) {
+            size_t size = header_arena_size ? header_arena_size : HTTP_HEADER_ARENA_SIZE;
+            while (header_arena_used + length + 1 > size) {
+                size *= 2;
+            }
+
+            char* arena = (char*)realloc(header_arena, size);
+            if (arena == NULL) {
+                printf("[HttpResponse] realloc for %d bytes of headers failed\n", size);
+                // the offsets may point past the arena, keep no header at all
+                header_overflow = true;
+                headers.clear();
+                content_type_ix = -1;
+                transfer_encoding_ix = -1;
+                return false;
+            }
+            header_arena = arena;
+            header_arena_size = size;
+        }
+
+        memcpy(header_arena + header_arena_used, at, length);
+        header_arena_used += length;
+        header_arena[header_arena_used] = 0;
+        return true;
+    }
+
+    void end_header_field() {
+        header_arena_used++;
+
+        // index the headers that are used by the library and most callers
+        int ix = headers.size() - 1;
+        const char* field = get_header_field(ix);
+        if (strcicmp(field, "content-type") == 0) {
+            content_type_ix = ix;
+        }
+        else if (strcicmp(field, "transfer-encoding") == 0) {
+            transfer_encoding_ix = ix;
+        }
+    }
+
+    void end_header_value() {
+        header_arena_used++;
+
+        int ix = headers.size() - 1;
+        if (strcicmp(get_header_field(ix), "content-length") == 0) {
+            expected_content_length = (size_t)atoi(get_header_value(ix));
+        }
+    }
+
+    void copy_headers() {
+        for (size_t ix = header_fields.size(); ix < headers.size(); ix++) {
+            header_fields.push_back(new string(get_header_field(ix)));
+            header_values.push_back(new string(get_header_value(ix)));
+        }
+    }
+
     // from http://stackoverflow.com/questions/5820810/case-insensitive-string-comp-in-c
     int strcicmp(char const *a, char const *b) {
         for (;; a++, b++) {
@@ -210,6 +477,14 @@ private:
     string url;
     http_method method;
 
+    vector<header_t> headers;
+    char* header_arena;
+    size_t header_arena_size;
+    size_t header_arena_used;
+    bool header_overflow;
+    int content_type_ix;
+    int transfer_encoding_ix;
+
     vector<string*> header_fields;
     vector<string*> header_values;
 
@@ -222,9 +497,15 @@ private:
 
     bool is_message_completed;
 
+    bool keep_alive;
+
     char * body;
     size_t body_length;
     size_t body_offset;
+    size_t body_capacity;
+    size_t body_max;
+    bool body_owned;
+    bool body_overflow;
 };
 
 #endif
@@ -0,0 +1,332 @@
+/*
+ * PackageLicenseDeclared: Apache-2.0
+ * Copyright (c) 2026 The mbed-js-st-fw-mqtt contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MBED_HTTPS_CONNECTION_POOL_H_
+#define _MBED_HTTPS_CONNECTION_POOL_H_
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "tls_socket.h"
+
+/* Number of hosts for which a TLS session is remembered */
+#ifndef HTTPS_SESSION_CACHE_SIZE
+#define HTTPS_SESSION_CACHE_SIZE 2
+#endif
+
+/* Number of connected sockets kept open between requests, 0 disables keep-alive */
+#ifndef HTTPS_MAX_IDLE_CONNECTIONS
+#define HTTPS_MAX_IDLE_CONNECTIONS 1
+#endif
+
+/* Idle sockets older than this are closed instead of reused */
+#ifndef HTTPS_IDLE_TIMEOUT_MS
+#define HTTPS_IDLE_TIMEOUT_MS 60000
+#endif
+
+struct https_pool_stats_t {
+    uint32_t reused;        // requests served on an idle connection
+    uint32_t resumed;       // abbreviated handshakes
+    uint32_t full;          // full handshakes
+    uint32_t stale;         // idle connections closed as expired or dropped by the server
+};
+
+/**
+ * \brief HttpsConnectionPool keeps TLS connections and sessions per host, shared by all HttpsRequest objects.
+ *
+ * A request first takes an idle connection to its host. Without one, it opens a new connection that offers
+ * the session (or session ticket) from the last handshake with that host, so the server can skip the
+ * certificate exchange and key agreement.
+ */
+class HttpsConnectionPool {
+public:
+    /**
+     * Get a connected socket to host:port.
+     *
+     * The handshake runs outside the pool lock, it takes seconds and would hold up requests to
+     * every other host. The cached session is taken out of the cache for it, so a concurrent
+     * request to the same host does a full handshake instead of sharing it.
+     *
+     * @param[in] net_iface The network interface
+     * @param[in] host Host name
+     * @param[in] port Port
+     * @param[in] ssl_ca_pem String containing the trusted CAs, must stay valid until release().
+     *                       A cached session or idle connection is only used with the CAs that verified it.
+     * @param[in] debug Debug flag for the socket
+     * @param[out] reused Set when the socket was an idle connection
+     * @param[out] error Error code when NULL is returned
+     * @return A connected TLSSocket, or NULL on failure
+     */
+    static TLSSocket* acquire(NetworkInterface* net_iface, const char* host, uint16_t port,
+                              const char* ssl_ca_pem, bool debug, bool* reused, nsapi_error_t* error) {
+        State& s = state();
+        s.mutex.lock();
+
+        *reused = false;
+        uint32_t ca_hash = hash_ca(ssl_ca_pem);
+        Entry* entry = find(host, port);
+        TLSSocket* stale = NULL;
+
+        if (entry && entry->idle) {
+            TLSSocket* socket = entry->idle;
+            uint32_t idle_ms = (us_ticker_read() - entry->idle_since) / 1000;
+            entry->idle = NULL;
+            s.idle_count--;
+
+            if (entry->ca_hash == ca_hash && idle_ms < HTTPS_IDLE_TIMEOUT_MS && is_alive(socket)) {
+                entry->last_used = us_ticker_read();
+                s.stats.reused++;
+                s.mutex.unlock();
+                socket->set_debug(debug);
+                *reused = true;
+                return socket;
+            }
+
+            s.stats.stale++;
+            stale = socket;
+        }
+
+        // moved out of the entry, the entry no longer owns its allocations
+        mbedtls_ssl_session session;
+        bool has_session = false;
+        if (entry && entry->has_session && entry->ca_hash == ca_hash) {
+            // a resumed session skips certificate verification, never carry one over to other CAs
+            session = entry->session;
+            has_session = true;
+            entry->has_session = false;
+            mbedtls_ssl_session_init(&entry->session);
+        }
+
+        s.mutex.unlock();
+
+        if (stale) {
+            stale->close();
+            delete stale;
+        }
+
+        TLSSocket* socket = new TLSSocket(net_iface, host, port, ssl_ca_pem);
+        socket->set_debug(debug);
+        if (has_session) {
+            socket->set_session(&session);
+        }
+
+        nsapi_error_t r = socket->connect();
+        socket->set_session(NULL);      // connect() took its own copy
+
+        s.mutex.lock();
+
+        entry = find(host, port);
+        if (!entry) {
+            entry = evict();
+            entry->host = strdup(host);
+            entry->port = port;
+        }
+        else if (entry->ca_hash != ca_hash) {
+            forget_session(entry);
+        }
+        entry->ca_hash = ca_hash;
+        entry->last_used = us_ticker_read();
+
+        if (r != 0) {
+            // the server may have refused the session, start over with a full handshake next time
+            s.mutex.unlock();
+            if (has_session) {
+                mbedtls_ssl_session_free(&session);
+            }
+            delete socket;
+            *error = r;
+            return NULL;
+        }
+
+        if (socket->session_resumed()) {
+            s.stats.resumed++;
+            if (!entry->has_session) {
+                // back into the cache
+                entry->session = session;
+                entry->has_session = true;
+                has_session = false;
+            }
+        }
+        else {
+            s.stats.full++;
+            forget_session(entry);
+            if (socket->get_session(&entry->session) == 0) {
+                entry->has_session = true;
+            }
+        }
+
+        s.mutex.unlock();
+
+        if (has_session) {
+            mbedtls_ssl_session_free(&session);
+        }
+        return socket;
+    }
+
+    /**
+     * Hand a socket from acquire() back.
+     *
+     * @param[in] socket The socket
+     * @param[in] keep_alive Whether the connection can carry another request
+     */
+    static void release(TLSSocket* socket, bool keep_alive) {
+        State& s = state();
+        s.mutex.lock();
+
+        Entry* entry = find(socket->get_hostname(), socket->get_port());
+        if (keep_alive && entry && !entry->idle && s.idle_count < HTTPS_MAX_IDLE_CONNECTIONS &&
+                socket->connected() && socket->error() == 0) {
+            entry->idle = socket;
+            entry->idle_since = us_ticker_read();
+            s.idle_count++;
+            s.mutex.unlock();
+            return;
+        }
+
+        s.mutex.unlock();
+        socket->close();
+        delete socket;
+    }
+
+    /**
+     * Close all idle connections and forget all sessions.
+     */
+    static void clear() {
+        State& s = state();
+        s.mutex.lock();
+        for (size_t ix = 0; ix < HTTPS_SESSION_CACHE_SIZE; ix++) {
+            drop(&s.entries[ix]);
+        }
+        s.mutex.unlock();
+    }
+
+    static https_pool_stats_t get_stats() {
+        return state().stats;
+    }
+
+private:
+    struct Entry {
+        char* host;
+        uint16_t port;
+        uint32_t ca_hash;       // of the CAs the session was verified against
+        uint32_t last_used;
+
+        bool has_session;
+        mbedtls_ssl_session session;
+
+        TLSSocket* idle;
+        uint32_t idle_since;
+    };
+
+    struct State {
+        State() {
+            memset(&stats, 0, sizeof(stats));
+            idle_count = 0;
+            for (size_t ix = 0; ix < HTTPS_SESSION_CACHE_SIZE; ix++) {
+                entries[ix].host = NULL;
+                entries[ix].idle = NULL;
+                entries[ix].has_session = false;
+                mbedtls_ssl_session_init(&entries[ix].session);
+            }
+        }
+
+        Mutex mutex;
+        Entry entries[HTTPS_SESSION_CACHE_SIZE];
+        size_t idle_count;
+        https_pool_stats_t stats;
+    };
+
+    // function local, so the header-only library has a single instance without a .cpp file
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static Entry* find(const char* host, uint16_t port) {
+        State& s = state();
+        for (size_t ix = 0; ix < HTTPS_SESSION_CACHE_SIZE; ix++) {
+            if (s.entries[ix].host && s.entries[ix].port == port && strcmp(s.entries[ix].host, host) == 0) {
+                return &s.entries[ix];
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * Free slot, or the least recently used one emptied.
+     */
+    static Entry* evict() {
+        State& s = state();
+        Entry* oldest = &s.entries[0];
+        uint32_t now = us_ticker_read();
+        for (size_t ix = 0; ix < HTTPS_SESSION_CACHE_SIZE; ix++) {
+            if (!s.entries[ix].host) {
+                return &s.entries[ix];
+            }
+            if (now - s.entries[ix].last_used > now - oldest->last_used) {
+                oldest = &s.entries[ix];
+            }
+        }
+        drop(oldest);
+        return oldest;
+    }
+
+    static void drop(Entry* entry) {
+        if (entry->idle) {
+            entry->idle->close();
+            delete entry->idle;
+            entry->idle = NULL;
+            state().idle_count--;
+        }
+        forget_session(entry);
+        free(entry->host);
+        entry->host = NULL;
+    }
+
+    /**
+     * FNV-1a of the CA string. The contents are compared, a caller may reuse a buffer for other CAs.
+     */
+    static uint32_t hash_ca(const char* pem) {
+        uint32_t h = 2166136261UL;
+        for (; pem && *pem; pem++) {
+            h = (h ^ (unsigned char)*pem) * 16777619UL;
+        }
+        return h;
+    }
+
+    static void forget_session(Entry* entry) {
+        if (entry->has_session) {
+            mbedtls_ssl_session_free(&entry->session);
+            mbedtls_ssl_session_init(&entry->session);
+            entry->has_session = false;
+        }
+    }
+
+    /**
+     * Peek at an idle socket. Nothing to read means the server still holds the connection,
+     * EOF or a pending record (usually its close_notify) means it has given up on it.
+     */
+    static bool is_alive(TLSSocket* socket) {
+        uint8_t b;
+        TCPSocket* tcp = socket->get_tcp_socket();
+        tcp->set_blocking(false);
+        nsapi_size_or_error_t r = tcp->recv(&b, 1);
+        tcp->set_blocking(true);
+        return r == NSAPI_ERROR_WOULD_BLOCK;
+    }
+};
+
+#endif // _MBED_HTTPS_CONNECTION_POOL_H_
@@ -27,6 +27,7 @@
 #include "http_request_parser.h"
 #include "http_parsed_url.h"
 #include "tls_socket.h"
+#include "https_connection_pool.h"
 
 /**
  * \brief HttpsRequest implements the logic for interacting with HTTPS servers.
@@ -35,7 +36,8 @@ class HttpsRequest {
 public:
     /**
      * HttpsRequest Constructor
-     * Initializes the TCP socket, sets up event handlers and flags.
+     * Sets up event handlers and flags. The connection is taken from the HttpsConnectionPool on send(),
+     * so requests to the same host share connections and TLS sessions.
      *
      * @param[in] net_iface The network interface
      * @param[in] ssl_ca_pem String containing the trusted CAs
@@ -53,11 +55,18 @@ public:
     {
         _parsed_url = new ParsedUrl(url);
         _body_callback = body_callback;
+        _body_buffer = NULL;
+        _body_buffer_size = 0;
+        _max_body = 0;
+        _repeatable = false;
         _request_builder = new HttpRequestBuilder(method, _parsed_url);
         _response = NULL;
         _debug = false;
+        _error = 0;
 
-        _tlssocket = new TLSSocket(net_iface, _parsed_url->host(), _parsed_url->port(), ssl_ca_pem);
+        _net_iface = net_iface;
+        _ssl_ca_pem = ssl_ca_pem;
+        _tlssocket = NULL;
         _we_created_the_socket = true;
     }
 
@@ -79,10 +88,17 @@ public:
     {
         _parsed_url = new ParsedUrl(url);
         _body_callback = body_callback;
+        _body_buffer = NULL;
+        _body_buffer_size = 0;
+        _max_body = 0;
+        _repeatable = false;
         _request_builder = new HttpRequestBuilder(method, _parsed_url);
         _response = NULL;
         _debug = false;
+        _error = 0;
 
+        _net_iface = NULL;
+        _ssl_ca_pem = NULL;
         _tlssocket = socket;
         _we_created_the_socket = false;
     }
@@ -96,7 +112,7 @@ public:
         }
 
         if (_tlssocket && _we_created_the_socket) {
-            delete _tlssocket;
+            HttpsConnectionPool::release(_tlssocket, false);
         }
 
         if (_parsed_url) {
@@ -110,6 +126,7 @@ public:
 
     /**
      * Execute the HTTPS request.
+     * A second send() fails with error -2100, unless set_repeatable() was called.
      *
      * @param[in] body Pointer to the request body
      * @param[in] body_size Size of the request body
@@ -117,30 +134,197 @@ public:
      *         See get_error() for the error code.
      */
     HttpResponse* send(const void* body = NULL, nsapi_size_t body_size = 0) {
-        // not tried to connect before?
-        if (_tlssocket->error() != 0) {
-            _error = _tlssocket->error();
+        size_t request_size = 0;
+        char* request = _request_builder->build(body, body_size, request_size);
+
+        HttpResponse* res = execute(request, request_size, 0, 0);
+
+        free(request);
+        return res;
+    }
+
+    /**
+     * Execute the HTTPS request with a body that is pulled from a callback while it is sent.
+     * Only the headers and one chunk of HTTP_SEND_CHUNK_SIZE bytes are held in RAM.
+     *
+     * @param[in] body_source Callback that fills at most size bytes of buffer with the next part of the body,
+     *                        and returns the number of bytes filled, 0 at the end of the body
+     * @param[in] body_size Length of the body, or -1 if it is not known up front. The body is then sent
+     *                      with 'Transfer-Encoding: chunked'.
+     * @return An HttpResponse pointer on success, or NULL on failure.
+     *         See get_error() for the error code.
+     */
+    HttpResponse* send_stream(Callback<size_t(char* buffer, size_t size)> body_source, int body_size = -1) {
+        size_t head_size = 0;
+        char* head = _request_builder->build_head(body_size, head_size);
+
+        HttpResponse* res = execute(head, head_size, body_source, body_size);
+
+        free(head);
+        return res;
+    }
+
+    /**
+     * Closes the underlying TCP socket
+     */
+    void close() {
+        if (_tlssocket) {
+            _tlssocket->get_tcp_socket()->close();
+        }
+    }
+
+    /**
+     * Set a header for the request.
+     *
+     * The 'Host' and 'Content-Length' headers are set automatically.
+     * Setting the same header twice will overwrite the previous entry.
+     *
+     * @param[in] key Header key
+     * @param[in] value Header value
+     */
+    void set_header(string key, string value) {
+        _request_builder->set_header(key, value);
+    }
+
+    /**
+     * Collect the response body in buffer instead of on the heap.
+     * A larger body fails the request with error -2103.
+     *
+     * @param[in] buffer Buffer, must stay valid as long as the response
+     * @param[in] size Size of buffer
+     */
+    void set_body_buffer(void* buffer, size_t size) {
+        _body_buffer = buffer;
+        _body_buffer_size = size;
+    }
+
+    /**
+     * Fail the request with error -2103 when the response body is larger than max_body bytes.
+     * 0, the default, is no limit.
+     */
+    void set_max_body(size_t max_body) {
+        _max_body = max_body;
+    }
+
+    /**
+     * Allow send() to be called again to repeat the request, for example to poll an endpoint.
+     * Each send() then deletes the HttpResponse of the previous one, do not hold on to it.
+     */
+    void set_repeatable(bool repeatable) {
+        _repeatable = repeatable;
+    }
+
+    /**
+     * Get the error code.
+     *
+     * When send() fails, this error is set.
+     */
+    nsapi_error_t get_error() {
+        return _error;
+    }
+
+    /**
+     * Set the debug flag.
+     *
+     * If this flag is set, debug information from mbed TLS will be logged to stdout.
+     */
+    void set_debug(bool debug) {
+        _debug = debug;
+
+        if (_tlssocket) {
+            _tlssocket->set_debug(debug);
+        }
+    }
+
+
+protected:
+    HttpResponse* execute(const char* request, size_t request_size,
+                          Callback<size_t(char* buffer, size_t size)> body_source, int body_size) {
+        if (_response != NULL && !_repeatable) {
+            // already executed this response
+            _error = -2100;
             return NULL;
         }
 
-        bool socket_was_open = _tlssocket->connected();
+        bool socket_was_open = true;
+        bool reused = false;
 
-        if (!socket_was_open) {
-            nsapi_error_t r = _tlssocket->connect();
-            if (r != 0) {
-                _error = r;
+        if (_we_created_the_socket) {
+            _tlssocket = HttpsConnectionPool::acquire(_net_iface, _parsed_url->host(), _parsed_url->port(),
+                                                      _ssl_ca_pem, _debug, &reused, &_error);
+            if (!_tlssocket) {
                 return NULL;
             }
         }
+        else {
+            // not tried to connect before?
+            if (_tlssocket->error() != 0) {
+                _error = _tlssocket->error();
+                return NULL;
+            }
 
-        int ret;
+            socket_was_open = _tlssocket->connected();
 
-        size_t request_size = 0;
-        char* request = _request_builder->build(body, body_size, request_size);
+            if (!socket_was_open) {
+                nsapi_error_t r = _tlssocket->connect();
+                if (r != 0) {
+                    _error = r;
+                    return NULL;
+                }
+            }
+        }
 
-        ret = mbedtls_ssl_write(_tlssocket->get_ssl_context(), (const unsigned char *) request, request_size);
+        bool committed = false;
+        int ret = exchange(request, request_size, body_source, body_size, committed);
 
-        free(request);
+        if (ret < 0 && reused && !committed) {
+            // the server dropped the idle connection while it was pooled, try once more on a fresh one
+            HttpsConnectionPool::release(_tlssocket, false);
+            _tlssocket = HttpsConnectionPool::acquire(_net_iface, _parsed_url->host(), _parsed_url->port(),
+                                                      _ssl_ca_pem, _debug, &reused, &_error);
+            if (_tlssocket) {
+                ret = exchange(request, request_size, body_source, body_size, committed);
+            }
+        }
+
+        if (_we_created_the_socket) {
+            if (_tlssocket) {
+                HttpsConnectionPool::release(_tlssocket, ret > 0 && _response->is_keep_alive());
+                _tlssocket = NULL;
+            }
+        }
+        else if (ret >= 0 && !socket_was_open) {
+            _tlssocket->get_tcp_socket()->close();
+        }
+
+        if (ret < 0) {
+            return NULL;
+        }
+
+        return _response;
+    }
+
+    /**
+     * Write the request and read the response into _response.
+     *
+     * @param[out] committed Set once the request cannot be replayed: response data was read,
+     *                       the body source was called, or a non-idempotent request was sent
+     * @return The last mbedtls_ssl_read() result, > 0 when the message completed before the server closed
+     *         the connection, or < 0 on failure. See get_error() for the error code.
+     */
+    int exchange(const char* request, size_t request_size,
+                 Callback<size_t(char* buffer, size_t size)> body_source, int body_size, bool& committed) {
+        int ret = ssl_write_all(request, request_size);
+
+        if (ret >= 0 && body_source) {
+            ret = HttpRequestBuilder::stream_body(callback(this, &HttpsRequest::ssl_write_all),
+                                                  body_source, body_size, committed);
+            if (ret == -2102 || ret == NSAPI_ERROR_NO_MEMORY) {
+                // not a TLS error, but the server is still waiting for the rest of the body
+                onError(_tlssocket->get_tcp_socket(), ret);
+                return ret;
+            }
+        }
 
         if (ret < 0) {
             if (ret != MBEDTLS_ERR_SSL_WANT_READ &&
@@ -151,19 +335,33 @@ public:
             else {
                 _error = ret;
             }
-            return NULL;
+            return ret;
+        }
+
+        // the server may act on it even if the response never comes (RFC 7230 6.3.1)
+        if (!_request_builder->is_idempotent()) {
+            committed = true;
         }
 
         // Create a response object
+        if (_response) {
+            delete _response;
+        }
         _response = new HttpResponse();
+        if (_body_buffer) {
+            _response->set_body_buffer(_body_buffer, _body_buffer_size);
+        }
+        _response->set_max_body(_max_body);
         // And a response parser
         HttpParser parser(_response, HTTP_RESPONSE, _body_callback);
 
-        // Set up a receive buffer (on the heap)
-        uint8_t* recv_buffer = (uint8_t*)malloc(HTTP_RECEIVE_BUFFER_SIZE);
+        // Set up a receive buffer (on the heap), with room for the terminator
+        uint8_t* recv_buffer = (uint8_t*)malloc(HTTP_RECEIVE_BUFFER_SIZE + 1);
 
         /* Read data out of the socket */
         while ((ret = mbedtls_ssl_read(_tlssocket->get_ssl_context(), (unsigned char *) recv_buffer, HTTP_RECEIVE_BUFFER_SIZE)) > 0) {
+            committed = true;
+
             // Don't know if this is actually needed, but OK
             size_t _bpos = static_cast<size_t>(ret);
             recv_buffer[_bpos] = 0;
@@ -172,9 +370,10 @@ public:
             if (nparsed != _bpos) {
                 print_mbedtls_error("parser_error", nparsed);
                 // parser error...
-                _error = -2101;
+                _error = _response->is_header_overflow() ? NSAPI_ERROR_NO_MEMORY :
+                         _response->is_body_overflow() ? -2103 : -2101;
                 free(recv_buffer);
-                return NULL;
+                return -1;
             }
 
             if (_response->is_message_complete()) {
@@ -190,62 +389,38 @@ public:
                 _error = ret;
             }
             free(recv_buffer);
-            return NULL;
+            return ret;
         }
 
         parser.finish();
 
-        if (!socket_was_open) {
-            _tlssocket->get_tcp_socket()->close();
-        }
-
         free(recv_buffer);
 
-        return _response;
-    }
-
-    /**
-     * Closes the underlying TCP socket
-     */
-    void close() {
-        _tlssocket->get_tcp_socket()->close();
-    }
-
-    /**
-     * Set a header for the request.
-     *
-     * The 'Host' and 'Content-Length' headers are set automatically.
-     * Setting the same header twice will overwrite the previous entry.
-     *
-     * @param[in] key Header key
-     * @param[in] value Header value
-     */
-    void set_header(string key, string value) {
-        _request_builder->set_header(key, value);
-    }
+        if (!_response->is_message_complete()) {
+            // closed before the whole response came, e.g. a pooled connection the server dropped
+            _error = NSAPI_ERROR_CONNECTION_LOST;
+            return _error;
+        }
 
-    /**
-     * Get the error code.
-     *
-     * When send() fails, this error is set.
-     */
-    nsapi_error_t get_error() {
-        return _error;
+        return ret;
     }
 
     /**
-     * Set the debug flag.
-     *
-     * If this flag is set, debug information from mbed TLS will be logged to stdout.
+     * mbedtls_ssl_write may take less than all of it, keep going until it has.
      */
-    void set_debug(bool debug) {
-        _debug = debug;
-
-        _tlssocket->set_debug(debug);
+    nsapi_size_or_error_t ssl_write_all(const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*)data;
+        while (size > 0) {
+            int r = mbedtls_ssl_write(_tlssocket->get_ssl_context(), p, size);
+            if (r < 0) {
+                return r;
+            }
+            p += r;
+            size -= r;
+        }
+        return 0;
     }
 
-
-protected:
     /**
      * Helper for pretty-printing mbed TLS error codes
      */
@@ -261,10 +436,16 @@ protected:
     }
 
 protected:
+    NetworkInterface* _net_iface;
+    const char* _ssl_ca_pem;
     TLSSocket* _tlssocket;
     bool _we_created_the_socket;
 
     Callback<void(const char *at, size_t length)> _body_callback;
+    void* _body_buffer;
+    size_t _body_buffer_size;
+    size_t _max_body;
+    bool _repeatable;
     ParsedUrl* _parsed_url;
     HttpRequestBuilder* _request_builder;
     HttpResponse* _response;
@@ -50,9 +50,13 @@ public:
         _ssl_ca_pem = ssl_ca_pem;
         _is_connected = false;
         _debug = false;
-        _hostname = hostname;
+        // keep our own copy, a pooled socket outlives the URL it was opened for
+        _hostname = strdup(hostname);
         _port = port;
         _error = 0;
+        _resume_session = NULL;
+        _resumed = false;
+        _handshake_ms = 0;
 
         DRBG_PERS = "mbed TLS helloword client";
 
@@ -75,6 +79,8 @@ public:
             delete _tcpsocket;
         }
 
+        free(_hostname);
+
         // @todo: free DRBG_PERS ?
     }
 
@@ -130,6 +136,13 @@ public:
 
         mbedtls_ssl_set_hostname(&_ssl, _hostname);
 
+        if (_resume_session) {
+            // offer the cached session, the server falls back to a full handshake if it has forgotten it
+            if ((ret = mbedtls_ssl_set_session(&_ssl, _resume_session)) != 0) {
+                print_mbedtls_error("mbedtls_ssl_set_session", ret);
+            }
+        }
+
         mbedtls_ssl_set_bio(&_ssl, static_cast<void *>(_tcpsocket),
                                    ssl_send, ssl_recv, NULL );
 
@@ -144,7 +157,10 @@ public:
 
        /* Start the handshake, the rest will be done in onReceive() */
         if (_debug) mbedtls_printf("Starting the TLS handshake...\r\n");
+        Timer handshake_timer;
+        handshake_timer.start();
         ret = mbedtls_ssl_handshake(&_ssl);
+        _handshake_ms = handshake_timer.read_ms();
         if (ret < 0) {
             if (ret != MBEDTLS_ERR_SSL_WANT_READ &&
                 ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
@@ -160,20 +176,28 @@ public:
         /* It also means the handshake is done, time to print info */
         if (_debug) mbedtls_printf("TLS connection to %s:%d established\r\n", _hostname, _port);
 
-        const uint32_t buf_size = 1024;
-        char buf[buf_size] = { 0 };
-        mbedtls_x509_crt_info(buf, buf_size, "\r    ",
-                        mbedtls_ssl_get_peer_cert(&_ssl));
-        if (_debug) mbedtls_printf("Server certificate:\r\n%s\r", buf);
+        // a resumed session keeps the master secret of the session we offered
+        _resumed = _resume_session && _ssl.session &&
+                   memcmp(_ssl.session->master, _resume_session->master, sizeof(_resume_session->master)) == 0;
+        if (_debug) mbedtls_printf("Handshake took %d ms (%s)\r\n", _handshake_ms, _resumed ? "resumed" : "full");
 
-        uint32_t flags = mbedtls_ssl_get_verify_result(&_ssl);
-        if( flags != 0 )
-        {
-            mbedtls_x509_crt_verify_info(buf, buf_size, "\r  ! ", flags);
-            if (_debug) mbedtls_printf("Certificate verification failed:\r\n%s\r\r\n", buf);
-        }
-        else {
-            if (_debug) mbedtls_printf("Certificate verification passed\r\n\r\n");
+        if (_debug) {
+            // only rendered when it is printed, formatting the certificate is not free
+            const uint32_t buf_size = 1024;
+            char buf[buf_size] = { 0 };
+            mbedtls_x509_crt_info(buf, buf_size, "\r    ",
+                            mbedtls_ssl_get_peer_cert(&_ssl));
+            mbedtls_printf("Server certificate:\r\n%s\r", buf);
+
+            uint32_t flags = mbedtls_ssl_get_verify_result(&_ssl);
+            if( flags != 0 )
+            {
+                mbedtls_x509_crt_verify_info(buf, buf_size, "\r  ! ", flags);
+                mbedtls_printf("Certificate verification failed:\r\n%s\r\r\n", buf);
+            }
+            else {
+                mbedtls_printf("Certificate verification passed\r\n\r\n");
+            }
         }
 
         _is_connected = true;
@@ -197,6 +221,58 @@ public:
         return &_ssl;
     }
 
+    const char* get_hostname() {
+        return _hostname;
+    }
+
+    uint16_t get_port() {
+        return _port;
+    }
+
+    /**
+     * Notify the server and close the underlying TCP socket.
+     */
+    void close() {
+        if (_is_connected) {
+            mbedtls_ssl_close_notify(&_ssl);
+            _is_connected = false;
+        }
+        _tcpsocket->close();
+    }
+
+    /**
+     * Offer a previously negotiated session on the next connect(), to skip the full handshake.
+     * The session must stay valid until connect() returns.
+     */
+    void set_session(const mbedtls_ssl_session* session) {
+        _resume_session = session;
+    }
+
+    /**
+     * Copy the negotiated session, for resuming it on a later connection.
+     * Free the destination with mbedtls_ssl_session_free() before reusing it.
+     */
+    int get_session(mbedtls_ssl_session* session) {
+        if (!_is_connected) {
+            return -1;
+        }
+        return mbedtls_ssl_get_session(&_ssl, session);
+    }
+
+    /**
+     * Whether the last connect() resumed the session given to set_session().
+     */
+    bool session_resumed() {
+        return _resumed;
+    }
+
+    /**
+     * Duration of the last handshake in ms.
+     */
+    int handshake_ms() {
+        return _handshake_ms;
+    }
+
     /**
      * Set the debug flag.
      *
@@ -314,12 +390,16 @@ private:
 
     const char* DRBG_PERS;
     const char* _ssl_ca_pem;
-    const char* _hostname;
+    char* _hostname;
     uint16_t _port;
 
     bool _debug;
     bool _is_connected;
 
+    const mbedtls_ssl_session* _resume_session;
+    bool _resumed;
+    int _handshake_ms;
+
     nsapi_error_t _error;
 
     mbedtls_entropy_context _entropy;
@@ -21,6 +21,12 @@
 #include "ATParser.h"
 #include "mbed_debug.h"
 
+#if defined(DEFERRED_LOG)
+// queue the AT traffic instead of printing it from the parser
+#include "DeferredLog.h"
+#define debug_if(condition, ...) do { if (condition) DLOG(__VA_ARGS__); } while (0)
+#endif
+
 
 // getc/putc handling with timeouts
 int ATParser::putc(char c)
@@ -8,6 +8,14 @@
 #include "mbed_trace.h"
 #define TRACE_GROUP  "SPIRIT"
 
+#if defined(DEFERRED_LOG) && MBED_CONF_MBED_TRACE_ENABLE && (MBED_TRACE_MAX_LEVEL >= TRACE_LEVEL_DEBUG)
+/* Keep tracing out of the radio timing, tr_debug is also used in IRQ context.
+ * Same level check as mbed_tracef, only the output is deferred. */
+#include "DeferredLog.h"
+#undef tr_debug
+#define tr_debug(...) do { if(mbed_trace_config_get() & TRACE_LEVEL_DEBUG) DLOG("[DBG ][" TRACE_GROUP "]: " __VA_ARGS__); } while(0)
+#endif
+
 /* Define beyond macro if you want to perform heavy debug tracing (includes tracing in IRQ context) */
 // #define HEAVY_TRACING
 
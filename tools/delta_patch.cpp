@@ -0,0 +1,402 @@
+/*
+ * @file    delta_patch.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Host tool making and applying firmware delta patches.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Runs on the development host, not on the board. Build with:
+ *
+ *   g++ -O2 -I../Flasher delta_patch.cpp ../Flasher/DeltaPatch.cpp -o delta_patch
+ *
+ * and use as:
+ *
+ *   ./delta_patch diff old.bin new.bin patch.bin    make a patch
+ *   ./delta_patch apply old.bin patch.bin new.bin   apply it as the board does
+ *   ./delta_patch sim [seed]                        simulate an update
+ *
+ * old.bin is the image the board runs now, as it sits in its slot. apply
+ * and sim go through the board's DeltaPatch, fed in random sized chunks as
+ * they come from the network.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "DeltaPatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/* Constants -----------------------------------------------------------------*/
+
+#define HASH_BITS       16
+#define SEED_LEN        8       // bytes hashed to find match candidates
+#define MAX_CANDIDATES  32      // candidates tried per position
+#define MIN_SCORE       16      // matches minus mismatches to start a diff
+#define MAX_GAP         32      // bytes past the best score before giving up
+
+typedef std::vector<uint8_t> Bytes;
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint32_t crc32(const uint8_t *p, size_t len){
+    uint32_t crc = 0xFFFFFFFF;
+    while(len--){
+        crc ^= *p++;
+        for(int k = 0; k < 8; k++){
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t seed_hash(const uint8_t *p){
+    uint32_t h = 2166136261u;
+    for(int i = 0; i < SEED_LEN; i++){
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h >> (32 - HASH_BITS);
+}
+
+static void put_le32(Bytes &out, uint32_t v){
+    for(int i = 0; i < 4; i++){
+        out.push_back(v >> (8 * i));
+    }
+}
+
+static void put_varint(Bytes &out, uint32_t v){
+    while(v >= 0x80){
+        out.push_back((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(v);
+}
+
+/**
+ * Extends an approximate match of new[pos..] against old[cand..], bsdiff
+ * style: the length kept is the one where matches outnumber mismatches by
+ * the most. Returns that margin, and the length in *len.
+ */
+static int score_match(const Bytes &old, const Bytes &neu, size_t cand, size_t pos, size_t *len){
+    int matches = 0;
+    int best = 0;
+    *len = 0;
+    for(size_t i = 0; cand + i < old.size() && pos + i < neu.size(); i++){
+        if(old[cand + i] == neu[pos + i]){
+            matches++;
+        }
+        int score = 2 * matches - (int)(i + 1);
+        if(score > best){
+            best = score;
+            *len = i + 1;
+        }
+        if(i + 1 - *len > MAX_GAP){
+            break;
+        }
+    }
+    return best;
+}
+
+struct Record {
+    size_t oldStart;
+    size_t newStart;
+    size_t diffLen;
+};
+
+static void put_record(Bytes &patch, const Bytes &old, const Bytes &neu, const Record &r,
+                       size_t extraEnd, size_t nextOld){
+    size_t extraLen = extraEnd - (r.newStart + r.diffLen);
+    int32_t seek = (int32_t)(nextOld - (r.oldStart + r.diffLen));
+
+    put_varint(patch, r.diffLen);
+    put_varint(patch, extraLen);
+    put_varint(patch, ((uint32_t)seek << 1) ^ (uint32_t)(seek >> 31));
+
+    // differences, with runs of zeros as a zero and the run length less one
+    for(size_t i = 0; i < r.diffLen; ){
+        uint8_t d = neu[r.newStart + i] - old[r.oldStart + i];
+        if(d != 0){
+            patch.push_back(d);
+            i++;
+            continue;
+        }
+        size_t run = 0;
+        while(i + run < r.diffLen && run < 256 && neu[r.newStart + i + run] == old[r.oldStart + i + run]){
+            run++;
+        }
+        patch.push_back(0);
+        patch.push_back(run - 1);
+        i += run;
+    }
+
+    patch.insert(patch.end(), neu.begin() + r.newStart + r.diffLen, neu.begin() + extraEnd);
+}
+
+static Bytes make_patch(const Bytes &old, const Bytes &neu){
+    Bytes patch;
+    put_le32(patch, DELTA_MAGIC);
+    put_le32(patch, old.size());
+    put_le32(patch, neu.size());
+    put_le32(patch, crc32(old.data(), old.size()));
+
+    // chains of old positions per seed hash, the most recent first
+    std::vector<int32_t> head(1 << HASH_BITS, -1);
+    std::vector<int32_t> prev(old.size(), -1);
+    for(size_t i = 0; i + SEED_LEN <= old.size(); i++){
+        uint32_t h = seed_hash(&old[i]);
+        prev[i] = head[h];
+        head[h] = i;
+    }
+
+    Record cur = { 0, 0, 0 };
+    size_t pos = 0;
+    while(pos < neu.size()){
+        // the position in line with the current diff catches changed pointers,
+        // the seeds catch moved code
+        size_t bestCand = 0;
+        size_t bestLen = 0;
+        int bestScore = 0;
+        size_t len;
+
+        size_t inLine = cur.oldStart + (pos - cur.newStart);
+        if(inLine < old.size()){
+            int score = score_match(old, neu, inLine, pos, &len);
+            if(score > bestScore){
+                bestScore = score;
+                bestCand = inLine;
+                bestLen = len;
+            }
+        }
+        if(pos + SEED_LEN <= neu.size()){
+            int32_t cand = head[seed_hash(&neu[pos])];
+            for(int n = 0; cand >= 0 && n < MAX_CANDIDATES; n++, cand = prev[cand]){
+                int score = score_match(old, neu, cand, pos, &len);
+                if(score > bestScore){
+                    bestScore = score;
+                    bestCand = cand;
+                    bestLen = len;
+                }
+            }
+        }
+
+        if(bestScore < MIN_SCORE){
+            pos++;
+            continue;
+        }
+
+        put_record(patch, old, neu, cur, pos, bestCand);
+        cur.oldStart = bestCand;
+        cur.newStart = pos;
+        cur.diffLen = bestLen;
+        pos += bestLen;
+    }
+    put_record(patch, old, neu, cur, neu.size(), cur.oldStart + cur.diffLen);
+    return patch;
+}
+
+static int collect(void *context, const uint8_t *data, size_t len){
+    Bytes *out = (Bytes *)context;
+    out->insert(out->end(), data, data + len);
+    return 0;
+}
+
+static int apply_patch(const Bytes &old, const Bytes &patch, Bytes &neu){
+    DeltaPatch patcher(old.data(), old.size(), crc32(old.data(), old.size()), collect, &neu);
+    neu.clear();
+    for(size_t pos = 0; pos < patch.size(); ){
+        size_t n = 1 + rand() % 1460;
+        if(n > patch.size() - pos){
+            n = patch.size() - pos;
+        }
+        int rc = patcher.feed(&patch[pos], n);
+        if(rc != 0){
+            return rc;
+        }
+        pos += n;
+    }
+    return patcher.finish();
+}
+
+static bool read_file(const char *path, Bytes &data){
+    FILE *f = fopen(path, "rb");
+    if(!f){
+        perror(path);
+        return false;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    data.clear();
+    while((n = fread(buf, 1, sizeof(buf), f)) > 0){
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool write_file(const char *path, const Bytes &data){
+    FILE *f = fopen(path, "wb");
+    if(!f || fwrite(data.data(), 1, data.size(), f) != data.size()){
+        perror(path);
+        if(f){
+            fclose(f);
+        }
+        return false;
+    }
+    fclose(f);
+    return true;
+}
+
+/**
+ * Something shaped like a Thumb image: instruction-like bytes with a
+ * literal pool word pointing into the image every few dozen bytes.
+ */
+static void make_image(Bytes &image, size_t size){
+    image.resize(size);
+    for(size_t i = 0; i < size; i += 2){
+        image[i] = rand() % 64;
+        image[i + 1] = 0x40 + rand() % 32;
+    }
+    for(size_t i = 0; i + 4 <= size; i += 32 + 4 * (rand() % 8)){
+        uint32_t target = 0x08020000 + (rand() % size & ~1u);
+        memcpy(&image[i], &target, 4);
+    }
+}
+
+/**
+ * A new version: a few functions grow, the code after them moves, and the
+ * pointers to the moved code change with it.
+ */
+static void make_update(const Bytes &old, Bytes &neu){
+    const size_t edits = 4;
+    size_t at[edits];
+    size_t grow[edits];
+    for(size_t e = 0; e < edits; e++){
+        at[e] = (old.size() / edits) * e + rand() % (old.size() / edits / 2);
+        grow[e] = 2 * (8 + rand() % 120);
+    }
+
+    // the literal pool words move with the code they point to, they are the
+    // only aligned words in the image range
+    Bytes moved(old);
+    for(size_t i = 0; i + 4 <= moved.size(); i += 4){
+        uint32_t w;
+        memcpy(&w, &moved[i], 4);
+        if(w < 0x08020000 || w >= 0x08020000 + old.size()){
+            continue;
+        }
+        uint32_t offset = w - 0x08020000;
+        for(size_t e = 0; e < edits; e++){
+            if(offset >= at[e]){
+                w += grow[e];
+            }
+        }
+        memcpy(&moved[i], &w, 4);
+    }
+
+    neu.clear();
+    size_t from = 0;
+    for(size_t e = 0; e < edits; e++){
+        neu.insert(neu.end(), moved.begin() + from, moved.begin() + at[e]);
+        for(size_t k = 0; k < grow[e]; k++){
+            neu.push_back(rand());
+        }
+        from = at[e];
+    }
+    neu.insert(neu.end(), moved.begin() + from, moved.end());
+}
+
+static int simulate(unsigned seed){
+    const size_t sizes[] = { 32 * 1024, 128 * 1024, 384 * 1024 };
+    int failed = 0;
+
+    srand(seed);
+    printf("%-10s %10s %10s %10s %7s  %s\n", "image", "old", "new", "patch", "ratio", "apply");
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        Bytes old, neu, patch, rebuilt;
+        make_image(old, sizes[s]);
+        make_update(old, neu);
+        patch = make_patch(old, neu);
+
+        int rc = apply_patch(old, patch, rebuilt);
+        bool ok = rc == 0 && rebuilt == neu;
+        failed += !ok;
+
+        char name[24];
+        snprintf(name, sizeof(name), "%zuK", sizes[s] / 1024);
+        printf("%-10s %10zu %10zu %10zu %6.1fx  %s\n", name, old.size(), neu.size(), patch.size(),
+               (double)neu.size() / patch.size(), ok ? "ok" : "FAILED");
+    }
+
+    // a patch for another image must be refused before anything is written
+    Bytes a, b, c, out;
+    make_image(a, 4096);
+    make_update(a, b);
+    make_image(c, 4096);
+    int rc = apply_patch(c, make_patch(a, b), out);
+    printf("wrong base %s\n", rc == DELTA_ERROR_BASE && out.empty() ? "refused" : "NOT REFUSED");
+    failed += rc != DELTA_ERROR_BASE;
+
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char **argv){
+    Bytes old, neu, patch;
+
+    if(argc == 5 && strcmp(argv[1], "diff") == 0){
+        if(!read_file(argv[2], old) || !read_file(argv[3], neu)){
+            return 1;
+        }
+        patch = make_patch(old, neu);
+        printf("%zu -> %zu bytes, %.1fx smaller\n", neu.size(), patch.size(), (double)neu.size() / patch.size());
+        return write_file(argv[4], patch) ? 0 : 1;
+    }
+    if(argc == 5 && strcmp(argv[1], "apply") == 0){
+        if(!read_file(argv[2], old) || !read_file(argv[3], patch)){
+            return 1;
+        }
+        int rc = apply_patch(old, patch, neu);
+        if(rc != 0){
+            printf("patch failed: %d\n", rc);
+            return 1;
+        }
+        return write_file(argv[4], neu) ? 0 : 1;
+    }
+    if(argc >= 2 && strcmp(argv[1], "sim") == 0){
+        return simulate(argc > 2 ? atoi(argv[2]) : 1);
+    }
+
+    fprintf(stderr, "usage: %s diff old new patch | apply old patch new | sim [seed]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,145 @@
+#!/usr/bin/env python
+# Rebuilds DeferredLog messages from a console capture.
+#
+# Runs on the development host, not on the board:
+#
+#   python dlog_decode.py BUILD/<target>/GCC_ARM/<app>.elf < console.log
+#   python dlog_decode.py --base 0x08000000 <app>.bin < console.log
+#
+# Every "DLOG <hex>" line is one DeferredLogRecord. The format strings only
+# exist in the firmware image, so it must be the image that produced the log.
+
+import argparse
+import re
+import struct
+import sys
+
+HEADER = struct.Struct('<IIBBBB')   # time_us, format, words, stringsLen, flags, reserved
+FLAG_TRUNCATED = 0x01
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|L|j|z|t)?([diouxXcfFeEgGaAspn%])')
+
+
+class Image(object):
+    """Read-only memory of the firmware, from an ELF file or a raw binary."""
+
+    def __init__(self, path, base):
+        with open(path, 'rb') as f:
+            data = f.read()
+        self.segments = []
+        if data[:4] == b'\x7fELF':
+            self._load_elf(data)
+        else:
+            self.segments.append((base, data))
+
+    def _load_elf(self, data):
+        # 32 bit little endian ELF, which is what arm-none-eabi produces
+        phoff, = struct.unpack_from('<I', data, 28)
+        phentsize, phnum = struct.unpack_from('<HH', data, 42)
+        for i in range(phnum):
+            p_type, p_offset, p_vaddr, p_paddr, p_filesz = struct.unpack_from('<IIIII', data, phoff + i * phentsize)
+            if p_type == 1 and p_filesz:    # PT_LOAD
+                self.segments.append((p_vaddr, data[p_offset:p_offset + p_filesz]))
+
+    def string(self, address):
+        for start, data in self.segments:
+            if start <= address < start + len(data):
+                end = data.find(b'\0', address - start)
+                if end < 0:
+                    end = len(data)
+                return data[address - start:end].decode('latin-1')
+        return None
+
+
+def render(fmt, words, strings):
+    """printf with the arguments the target captured, in the order it captured them."""
+    words = list(words)
+    strings = list(strings)
+    out = []
+    pos = 0
+
+    def word():
+        if not words:
+            raise IndexError
+        return words.pop(0)
+
+    def signed(value, bits):
+        return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+    try:
+        for m in CONVERSION.finditer(fmt):
+            out.append(fmt[pos:m.start()])
+            pos = m.end()
+            flags, width, precision, length, conv = m.groups()
+            if conv == '%':
+                out.append('%')
+                continue
+            if width == '*':
+                width = str(signed(word(), 32))
+            if precision == '*':
+                precision = str(signed(word(), 32))
+            spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+            wide = length in ('ll', 'j')
+
+            if conv in 'di':
+                value = word() | (word() << 32) if wide else word()
+                out.append((spec + 'd') % signed(value, 64 if wide else 32))
+            elif conv in 'uxXo':
+                value = word() | (word() << 32) if wide else word()
+                out.append((spec + ('d' if conv == 'u' else conv)) % value)
+            elif conv == 'c':
+                out.append((spec + 'c') % chr(word() & 0xFF))
+            elif conv in 'fFeEgGaA':
+                value, = struct.unpack('<d', struct.pack('<II', word(), word()))
+                out.append((spec + (conv if conv not in 'aA' else 'g')) % value)
+            elif conv == 's':
+                if not strings:
+                    raise IndexError
+                out.append((spec + 's') % strings.pop(0))
+            elif conv == 'p':
+                out.append('0x%08x' % word())
+    except IndexError:
+        out.append('...')
+        return ''.join(out)
+
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode(line, image):
+    record = bytearray.fromhex(line)
+    time_us, address, count, strings_len, flags, _ = HEADER.unpack_from(record, 0)
+    words = struct.unpack_from('<%dI' % count, record, HEADER.size)
+    raw = bytes(record[HEADER.size + 4 * count:HEADER.size + 4 * count + strings_len])
+    strings = [s.decode('latin-1') for s in raw.split(b'\0')[:-1]]
+
+    fmt = image.string(address)
+    if fmt is None:
+        text = '<format 0x%08x not in image> %s %s' % (address, ' '.join('%08x' % w for w in words), strings)
+    else:
+        text = render(fmt, words, strings)
+    if flags & FLAG_TRUNCATED:
+        text = text.rstrip('\r\n') + ' [truncated]'
+    return '%12.6f  %s' % (time_us / 1e6, text.rstrip('\r\n'))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Rebuild DeferredLog messages from a console capture.')
+    parser.add_argument('image', help='firmware .elf, or .bin together with --base')
+    parser.add_argument('--base', type=lambda s: int(s, 0), default=0x08000000,
+                        help='load address of a .bin image (default 0x08000000)')
+    args = parser.parse_args()
+    image = Image(args.image, args.base)
+
+    for line in sys.stdin:
+        m = re.search(r'DLOG ([0-9a-fA-F]+)', line)
+        if m:
+            print(decode(m.group(1), image))
+            continue
+        m = re.search(r'DLOGDROP (\d+)', line)
+        if m:
+            print('%12s  <%s messages dropped so far>' % ('', m.group(1)))
+
+
+if __name__ == '__main__':
+    main()
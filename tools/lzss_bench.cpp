@@ -0,0 +1,228 @@
+/*
+ * @file    lzss_bench.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Host benchmark of the LZSS payload codec.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Runs on the development host, not on the board. Build and run with:
+ *
+ *   g++ -O2 -I../Compression lzss_bench.cpp ../Compression/LZSS.cpp -o lzss_bench
+ *   ./lzss_bench
+ *
+ * For each payload it prints the compressed size as it goes over the wire
+ * (two byte envelope included) and the cost of compression and decompression
+ * in cycles per input byte, measured with the time stamp counter on x86 and
+ * estimated from a nominal clock elsewhere. Every payload is also checked to
+ * round trip through both the one shot and the streaming decoder.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "LZSS.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+/* Constants -----------------------------------------------------------------*/
+
+#define ENVELOPE_LEN    2
+#define ITERATIONS      2000
+#define NOMINAL_GHZ     1.0   // used to express nanoseconds as cycles without a TSC
+#define MAX_PAYLOAD     4096
+
+/* Payloads ------------------------------------------------------------------*/
+
+static const char telemetry[] =
+    "{\"id\":\"nucleo-f429zi\",\"temperature\":23.51,\"humidity\":41.20,"
+    "\"pressure\":1013.25,\"accelerometer\":[12,-4,1003],\"uptime\":86400}";
+
+static const char config[] =
+    "{\"sampling\":{\"temperature\":1000,\"humidity\":1000,\"pressure\":5000},"
+    "\"report\":{\"temperature\":{\"deadband\":0.5,\"min\":1000,\"max\":60000},"
+    "\"humidity\":{\"deadband\":1.0,\"min\":1000,\"max\":60000},"
+    "\"pressure\":{\"deadband\":0.1,\"min\":5000,\"max\":60000}}}";
+
+static const char logline[] =
+    "[INFO] mqtt: connected to broker customer.cloudmqtt.com:1883 as nucleo-f429zi, "
+    "keepalive 60 s, clean session 0, 3 subscriptions restored";
+
+// {"t":2351,"h":4120,"p":101325} encoded as CBOR
+static const unsigned char cbor[] = {
+    0xA3, 0x61, 0x74, 0x19, 0x09, 0x2F, 0x61, 0x68, 0x19, 0x10, 0x18,
+    0x61, 0x70, 0x1A, 0x00, 0x01, 0x8B, 0xCD
+};
+
+struct Payload {
+    const char *name;
+    unsigned char data[MAX_PAYLOAD];
+    size_t len;
+};
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint64_t ticks(){
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)((ts.tv_sec * 1000000000ULL + ts.tv_nsec) * NOMINAL_GHZ);
+#endif
+}
+
+static void set_payload(Payload *p, const char *name, const void *data, size_t len){
+    p->name = name;
+    p->len = len < MAX_PAYLOAD ? len : MAX_PAYLOAD;
+    memcpy(p->data, data, p->len);
+}
+
+struct Collector {
+    unsigned char data[MAX_PAYLOAD];
+    size_t len;
+};
+
+static int collect(void *context, const uint8_t *data, size_t len){
+    Collector *c = (Collector *)context;
+    if(c->len + len > sizeof(c->data)){
+        return 1;
+    }
+    memcpy(c->data + c->len, data, len);
+    c->len += len;
+    return 0;
+}
+
+static int round_trip(const Payload *p, const unsigned char *packed, int packedlen){
+    unsigned char out[MAX_PAYLOAD];
+    int len = LZSS::decompress(packed, packedlen, out, sizeof(out));
+    if(len != (int)p->len || memcmp(out, p->data, p->len) != 0){
+        return 1;
+    }
+
+    // feed the streaming decoder one byte at a time to cross every boundary
+    static Collector c;
+    c.len = 0;
+    LZSSDecoder decoder(collect, &c);
+    for(int i = 0; i < packedlen; i++){
+        if(decoder.feed(packed + i, 1) != 0){
+            return 2;
+        }
+    }
+    if(decoder.finish() != 0 || c.len != p->len || memcmp(c.data, p->data, p->len) != 0){
+        return 3;
+    }
+    return 0;
+}
+
+static int bench(const Payload *p){
+    static unsigned char packed[MAX_PAYLOAD * 2];
+    static unsigned char out[MAX_PAYLOAD];
+    int packedlen = 0;
+
+    uint64_t start = ticks();
+    for(int i = 0; i < ITERATIONS; i++){
+        packedlen = LZSS::compress(p->data, p->len, packed, sizeof(packed));
+    }
+    double compress_cpb = (double)(ticks() - start) / ITERATIONS / p->len;
+    if(packedlen < 0){
+        printf("%-22s compression failed\n", p->name);
+        return 1;
+    }
+
+    start = ticks();
+    for(int i = 0; i < ITERATIONS; i++){
+        LZSS::decompress(packed, packedlen, out, sizeof(out));
+    }
+    double decompress_cpb = (double)(ticks() - start) / ITERATIONS / p->len;
+
+    int rc = round_trip(p, packed, packedlen);
+
+    size_t wire = packedlen + ENVELOPE_LEN;
+    printf("%-22s %6zu %6zu %7.1f%% %10.1f %10.1f  %s\n", p->name, p->len, wire,
+           100.0 * wire / p->len, compress_cpb, decompress_cpb,
+           rc == 0 ? (wire < p->len ? "ok" : "ok, sent raw") : "ROUND TRIP FAILED");
+    return rc;
+}
+
+int main(){
+    static Payload payloads[7];
+    int count = 0;
+
+    set_payload(&payloads[count++], "json telemetry", telemetry, strlen(telemetry));
+    set_payload(&payloads[count++], "json config", config, strlen(config));
+    set_payload(&payloads[count++], "log line", logline, strlen(logline));
+    set_payload(&payloads[count++], "cbor telemetry", cbor, sizeof(cbor));
+
+    // a batch of telemetry samples, as sent after a reconnect
+    Payload *batch = &payloads[count++];
+    batch->name = "json batch x16";
+    batch->len = 0;
+    for(int i = 0; i < 16; i++){
+        batch->len += snprintf((char *)batch->data + batch->len, MAX_PAYLOAD - batch->len,
+                               "{\"temperature\":%d.%02d,\"humidity\":%d.%02d,\"uptime\":%d}\n",
+                               22 + i % 3, (i * 37) % 100, 40 + i % 5, (i * 53) % 100, 86400 + i * 60);
+    }
+
+    Payload *runs = &payloads[count++];
+    runs->name = "repetitive";
+    runs->len = 1024;
+    memset(runs->data, 'A', runs->len);
+
+    Payload *noise = &payloads[count++];
+    noise->name = "random";
+    noise->len = 240;
+    srand(1);
+    for(size_t i = 0; i < noise->len; i++){
+        noise->data[i] = rand() & 0xFF;
+    }
+
+#ifdef HAVE_TSC
+    printf("cycles measured with the time stamp counter\n\n");
+#else
+    printf("cycles estimated at %.1f GHz\n\n", NOMINAL_GHZ);
+#endif
+    printf("%-22s %6s %6s %8s %10s %10s\n", "payload", "bytes", "wire", "ratio", "comp c/B", "decomp c/B");
+
+    int failures = 0;
+    for(int i = 0; i < count; i++){
+        failures += bench(&payloads[i]) != 0;
+    }
+    return failures;
+}
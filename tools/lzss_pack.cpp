@@ -0,0 +1,154 @@
+/*
+ * @file    lzss_pack.cpp
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Host tool packing firmware images and patches with LZSS.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Runs on the development host, not on the board. Build with:
+ *
+ *   g++ -O2 -I../Compression lzss_pack.cpp ../Compression/LZSS.cpp -o lzss_pack
+ *
+ * and use as:
+ *
+ *   ./lzss_pack pack image.bin image.lzss      pack an image or a patch
+ *   ./lzss_pack unpack image.lzss image.bin    unpack it as the board does
+ *
+ * A packed file is downloaded with FirmwareSlots::download() or
+ * download_patch() and compressed set. pack checks the result round trips
+ * through the board's streaming decoder, fed in random sized chunks as they
+ * come from the network.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "LZSS.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+typedef std::vector<uint8_t> Bytes;
+
+/* Functions -----------------------------------------------------------------*/
+
+static int collect(void *context, const uint8_t *data, size_t len){
+    Bytes *out = (Bytes *)context;
+    out->insert(out->end(), data, data + len);
+    return 0;
+}
+
+static int unpack(const Bytes &packed, Bytes &data){
+    LZSSDecoder decoder(collect, &data);
+    data.clear();
+    for(size_t pos = 0; pos < packed.size(); ){
+        size_t n = 1 + rand() % 1460;
+        if(n > packed.size() - pos){
+            n = packed.size() - pos;
+        }
+        int rc = decoder.feed(&packed[pos], n);
+        if(rc != 0){
+            return rc;
+        }
+        pos += n;
+    }
+    return decoder.finish();
+}
+
+static bool read_file(const char *path, Bytes &data){
+    FILE *f = fopen(path, "rb");
+    if(!f){
+        perror(path);
+        return false;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    data.clear();
+    while((n = fread(buf, 1, sizeof(buf), f)) > 0){
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool write_file(const char *path, const Bytes &data){
+    FILE *f = fopen(path, "wb");
+    if(!f || fwrite(data.data(), 1, data.size(), f) != data.size()){
+        perror(path);
+        if(f){
+            fclose(f);
+        }
+        return false;
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv){
+    Bytes in, out, check;
+
+    if(argc == 4 && strcmp(argv[1], "pack") == 0){
+        if(!read_file(argv[2], in)){
+            return 1;
+        }
+        // a flag byte per eight literals is the worst case
+        out.resize(in.size() + in.size() / 8 + 1);
+        int len = LZSS::compress(in.data(), in.size(), out.data(), out.size());
+        if(len < 0){
+            printf("pack failed: %d\n", len);
+            return 1;
+        }
+        out.resize(len);
+        if(unpack(out, check) != 0 || check != in){
+            printf("pack failed: does not round trip\n");
+            return 1;
+        }
+        printf("%zu -> %zu bytes, %.1f%%\n", in.size(), out.size(), in.empty() ? 0.0 : 100.0 * out.size() / in.size());
+        return write_file(argv[3], out) ? 0 : 1;
+    }
+    if(argc == 4 && strcmp(argv[1], "unpack") == 0){
+        if(!read_file(argv[2], in)){
+            return 1;
+        }
+        int rc = unpack(in, out);
+        if(rc != 0){
+            printf("unpack failed: %d\n", rc);
+            return 1;
+        }
+        return write_file(argv[3], out) ? 0 : 1;
+    }
+
+    fprintf(stderr, "usage: %s pack in out | unpack in out\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,173 @@
+#!/usr/bin/env python
+# Pushes a firmware update to a board through its MQTT broker.
+#
+# Runs on the development host, not on the board. Needs paho-mqtt:
+#
+#   python mqtt_fw_push.py --host broker --topic fw/dev1 image.bin
+#   python mqtt_fw_push.py --host broker --topic fw/dev1 --compressed image.lzss --image image.bin
+#   python mqtt_fw_push.py --host broker --topic fw/dev1 --patch patch.bin --image new.bin
+#
+# The board calls setFirmwareTopic() with the same topic and the SHA-256
+# printed here, which it has to get from a source it trusts, not from this
+# tool. It refuses an offer for any other image. The protocol is described
+# in MQTT_JS/MQTTFirmware.h. The SHA-256 is the one of the image the board
+# ends up with, so --image is needed for a packed file or a patch. Stopping and running again with the same --id resumes a
+# transfer from where the board is.
+#
+# Images run in place from their slot, so the image has to be linked for
+# the slot the board reports in firmwareStatus().slot.
+
+import argparse
+import binascii
+import hashlib
+import struct
+import sys
+import time
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+OFFER = struct.Struct('<cBII32s')   # 'O', flags, transfer id, length, SHA-256
+CHUNK = struct.Struct('<cII')       # 'C', transfer id, offset
+ACK = struct.Struct('<cBIIIi')      # 'A', state, transfer id, offset, window, result
+
+FLAG_COMPRESSED = 0x01
+FLAG_PATCH = 0x02
+
+RECEIVING, INSTALLED, FAILED = 1, 2, 3
+
+VERIFY = 11                         # FIRMWARE_ERROR_VERIFY
+
+# MQTT_MAX_PACKET_SIZE on the board is 250 bytes, with the topic and the
+# headers the chunk data has to stay below about 200
+DEFAULT_CHUNK = 192
+
+
+class Transfer(object):
+    """Go-back-N sender: up to the board's window past its last ack, and
+    back to the last ack when nothing is heard for a while."""
+
+    def __init__(self, publish, data, sha256, transfer_id, flags, chunk, timeout):
+        self.publish = publish
+        self.data = data
+        self.sha256 = sha256
+        self.id = transfer_id
+        self.flags = flags
+        self.chunk = chunk
+        self.timeout = timeout
+        self.state = None
+        self.acked = 0
+        self.next = 0
+        self.window = 0
+        self.result = 0
+        self.heard = 0
+        self.sent = 0
+
+    def offer(self, now):
+        self.publish(OFFER.pack(b'O', self.flags, self.id, len(self.data), self.sha256))
+        self.heard = now
+
+    def on_ack(self, payload, now):
+        if len(payload) != ACK.size:
+            return
+        kind, state, transfer_id, offset, window, result = ACK.unpack(payload)
+        if kind != b'A' or transfer_id != self.id:
+            return
+        self.heard = now
+        self.state = state
+        self.window = window
+        self.result = result
+        if offset > self.acked:
+            self.acked = offset
+            self.next = max(self.next, offset)
+        elif offset == self.acked and self.next > offset:
+            self.next = offset  # the board is stuck at this offset, go back
+
+    def pump(self, now):
+        if self.state is None:
+            if now - self.heard > self.timeout:
+                self.offer(now)
+            return
+        if self.state != RECEIVING:
+            return
+        while self.next < len(self.data) and self.next - self.acked < self.window:
+            end = min(self.next + self.chunk, len(self.data))
+            self.publish(CHUNK.pack(b'C', self.id, self.next) + self.data[self.next:end])
+            self.next = end
+            self.sent += 1
+        if now - self.heard > self.timeout:
+            self.next = self.acked
+            self.heard = now
+
+    def done(self):
+        return self.state in (INSTALLED, FAILED)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Push a firmware update over MQTT.')
+    parser.add_argument('file', help='image, packed image or patch to send')
+    parser.add_argument('--host', required=True)
+    parser.add_argument('--port', type=int, default=1883)
+    parser.add_argument('--username')
+    parser.add_argument('--password')
+    parser.add_argument('--topic', required=True, help='topic the board passed to setFirmwareTopic()')
+    parser.add_argument('--image', help='image the board ends up with, for its SHA-256')
+    parser.add_argument('--compressed', action='store_true', help='file was packed with lzss_pack')
+    parser.add_argument('--patch', action='store_true', help='file was made with delta_patch')
+    parser.add_argument('--id', type=int, default=int(time.time()) & 0xFFFFFFFF, help='transfer id')
+    parser.add_argument('--chunk', type=int, default=DEFAULT_CHUNK, help='data bytes per message')
+    parser.add_argument('--timeout', type=float, default=5.0, help='seconds without an ack before resending')
+    args = parser.parse_args()
+
+    import paho.mqtt.client as mqtt
+
+    with open(args.file, 'rb') as f:
+        data = f.read()
+    if (args.compressed or args.patch) and not args.image:
+        parser.error('--image is needed with --compressed or --patch')
+    with open(args.image or args.file, 'rb') as f:
+        sha256 = hashlib.sha256(f.read()).digest()
+    flags = (FLAG_COMPRESSED if args.compressed else 0) | (FLAG_PATCH if args.patch else 0)
+    print('sha256 %s' % binascii.hexlify(sha256).decode())
+
+    client = mqtt.Client()
+    if args.username:
+        client.username_pw_set(args.username, args.password)
+
+    transfer = Transfer(lambda payload: client.publish(args.topic, payload, qos=0),
+                        data, sha256, args.id, flags, args.chunk, args.timeout)
+    # acks arrive on the network thread, the transfer runs on this one
+    acks = queue.Queue()
+    client.on_connect = lambda c, userdata, flags, rc: c.subscribe(args.topic + '/ack', qos=0)
+    client.on_message = lambda c, userdata, msg: acks.put(msg.payload)
+
+    client.connect(args.host, args.port)
+    client.loop_start()
+    transfer.heard = time.time() - args.timeout  # offer straight away
+
+    last = -1
+    while not transfer.done():
+        while not acks.empty():
+            transfer.on_ack(acks.get(), time.time())
+        transfer.pump(time.time())
+        if transfer.acked != last:
+            last = transfer.acked
+            sys.stdout.write('\r%d / %d bytes' % (last, len(data)))
+            sys.stdout.flush()
+        time.sleep(0.01)
+    client.loop_stop()
+
+    if transfer.state == INSTALLED:
+        print('\rinstalled, %d bytes in %d chunks' % (len(data), transfer.sent))
+        return 0
+    if transfer.result == VERIFY:
+        print('\rrefused, not the image with the SHA-256 the board expects')
+        return 1
+    print('\rfailed: %d' % transfer.result)
+    return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,144 @@
+/*
+ * @file    mqtt_trace_decode.c
+ * @author  mbed-js-st-fw-mqtt contributors
+ * @version V1.0.0
+ * @date    18 October 2026
+ * @brief   Host decoder of the MQTT packet trace ring.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2026 The mbed-js-st-fw-mqtt contributors</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of the copyright holder nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/*
+ * Runs on the development host, not on the board. Build with:
+ *
+ *   gcc -I../MQTT_JS/MQTT/MQTTPacket mqtt_trace_decode.c \
+ *       ../MQTT_JS/MQTT/MQTTPacket/MQTT*.c -o mqtt_trace_decode
+ *
+ * then pipe a console capture through it after calling dumpTrace() on a
+ * firmware built with MQTT_TRACE:
+ *
+ *   ./mqtt_trace_decode < console.log
+ *
+ * Every "MQTTTRACE <hex>" line is one MQTT::TraceRecord. Packets captured
+ * whole are rendered with MQTTFormat, the others from their header byte.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "MQTTPacket.h"
+#include "MQTTFormat.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Constants -----------------------------------------------------------------*/
+
+#define TRACE_TAG        "MQTTTRACE "
+#define TRACE_RECORD_LEN 16
+#define TRACE_HEAD       6
+
+/* Functions -----------------------------------------------------------------*/
+
+static int parse_hex(const char *hex, unsigned char *out, int len)
+{
+    int i;
+    for (i = 0; i < len; ++i)
+    {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1)
+            return 0;
+        out[i] = (unsigned char)byte;
+    }
+    return 1;
+}
+
+/* the board is little endian whatever the host is */
+static uint32_t get32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t get16(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+int main(void)
+{
+    char line[256];
+    int first = 1;
+    uint32_t start = 0, previous = 0;
+
+    while (fgets(line, sizeof(line), stdin))
+    {
+        unsigned char r[TRACE_RECORD_LEN];
+        char *tag = strstr(line, TRACE_TAG);
+        if (tag == NULL || !parse_hex(tag + strlen(TRACE_TAG), r, TRACE_RECORD_LEN))
+            continue;
+
+        uint32_t time_us = get32(r);
+        uint16_t len = get16(r + 4);
+        uint16_t id = get16(r + 6);
+        int rc = (signed char)r[8];
+        int sent = r[9];
+        unsigned char *head = r + 10;
+        MQTTHeader header = {0};
+        char text[120];
+
+        if (first)
+        {
+            start = previous = time_us;
+            first = 0;
+        }
+
+        header.byte = head[0];
+        text[0] = '\0';
+        if (len <= TRACE_HEAD && rc >= 0)
+        {
+            if (sent)
+                MQTTFormat_toServerString(text, sizeof(text) - 1, head, len);
+            else
+                MQTTFormat_toClientString(text, sizeof(text) - 1, head, len);
+        }
+        if (text[0] == '\0')
+        {
+            const char *name = (header.bits.type >= CONNECT && header.bits.type <= DISCONNECT) ?
+                MQTTPacket_getName(header.bits.type) : "?";
+            snprintf(text, sizeof(text), "%s dup %d qos %d retained %d id %u",
+                     name, header.bits.dup, header.bits.qos, header.bits.retain, id);
+        }
+
+        printf("%12.3f ms %+10.3f ms %s %-4u rc %3d  %s\n",
+               (uint32_t)(time_us - start) / 1000.0, (uint32_t)(time_us - previous) / 1000.0,
+               sent ? "->" : "<-", len, rc, text);
+        previous = time_us;
+    }
+    return 0;
+}